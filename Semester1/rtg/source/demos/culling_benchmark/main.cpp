@@ -0,0 +1,144 @@
+
+
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <framework/parallel.h>
+#include <framework/culling.h>
+#include <framework/timing.h>
+
+
+namespace
+{
+	const std::size_t object_count = 1000000;
+	const float world_size = 1000.0f;
+	const int frames = 20;
+
+	// a camera in the middle of the world, turning around the y axis with the frame
+	math::float4x4 viewProjection(int frame)
+	{
+		float angle = 0.3f * frame;
+		float c = std::cos(angle), s = std::sin(angle);
+		math::float4x4 view(c, 0.0f, -s, 0.0f,
+		                    0.0f, 1.0f, 0.0f, 0.0f,
+		                    s, 0.0f, c, 0.0f,
+		                    0.0f, 0.0f, 0.0f, 1.0f);
+
+		float fov = 3.14159265f / 3.0f, aspect = 16.0f / 9.0f, n = 0.1f, f = 0.5f * world_size;
+		float t = 1.0f / std::tan(fov * 0.5f);
+		math::float4x4 projection(t / aspect, 0.0f, 0.0f, 0.0f,
+		                          0.0f, t, 0.0f, 0.0f,
+		                          0.0f, 0.0f, -(f + n) / (f - n), -2.0f * f * n / (f - n),
+		                          0.0f, 0.0f, -1.0f, 0.0f);
+		return projection * view;
+	}
+
+	template <typename Cull>
+	double measure(Cull cull, std::vector<std::uint32_t>& visible, std::size_t& total_visible)
+	{
+		double ms = 0.0;
+		total_visible = 0;
+		for (int f = 0; f < frames; ++f)
+		{
+			math::frustum frustum = math::extract_frustum(viewProjection(f));
+			auto start = std::chrono::steady_clock::now();
+			cull(frustum, visible);
+			ms += millisecondsSince(start);
+			total_visible += visible.size();
+		}
+		return ms / frames;
+	}
+}
+
+// frustum culling of a million bounding spheres and boxes with every path the CPU has, on one and
+// on all hardware threads; every result is checked against the scalar one
+int main()
+{
+	try
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(-0.5f * world_size, 0.5f * world_size);
+		std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+		BoundingSpheres spheres;
+		BoundingBoxes boxes;
+		spheres.reserve(object_count);
+		boxes.reserve(object_count);
+		for (std::size_t i = 0; i < object_count; ++i)
+		{
+			math::float3 center(position(random), position(random), position(random));
+			math::float3 extent(size(random), size(random), size(random));
+			spheres.push_back(center, length(extent));
+			boxes.push_back(center - extent, center + extent);
+		}
+
+		std::vector<CullPath> paths(1, CullPath::SCALAR);
+		paths.push_back(CullPath::SSE);
+		if (bestCullPath() == CullPath::AVX)
+			paths.push_back(CullPath::AVX);
+
+		unsigned int threads = parallel::hardwareThreads();
+		// the split runs even on a single core, where it only shows its overhead
+		std::vector<unsigned int> worker_counts(1, 1U);
+		worker_counts.push_back(std::max(threads, 2U));
+
+		std::cout << object_count << " objects, average of " << frames << " frames, best path " << cullPathName(bestCullPath())
+		          << ", " << threads << " hardware threads" << std::endl;
+		std::cout << std::setw(8) << "volume" << std::setw(8) << "path" << std::setw(9) << "threads" << std::setw(12) << "ms"
+		          << std::setw(16) << "ns per object" << std::setw(12) << "visible" << std::setw(10) << "speedup" << std::endl;
+
+		std::vector<std::uint32_t> visible, reference;
+
+		for (int volume = 0; volume < 2; ++volume)
+		{
+			double scalar_ms = 0.0;
+			std::size_t scalar_visible = 0;
+
+			for (CullPath path : paths)
+				for (unsigned int workers : worker_counts)
+				{
+					std::size_t total_visible = 0;
+					double ms = volume == 0
+						? measure([&](const math::frustum& f, std::vector<std::uint32_t>& v) { cullSpheres(f, spheres, v, workers, path); }, visible, total_visible)
+						: measure([&](const math::frustum& f, std::vector<std::uint32_t>& v) { cullBoxes(f, boxes, v, workers, path); }, visible, total_visible);
+
+					if (path == CullPath::SCALAR && workers == 1)
+					{
+						scalar_ms = ms;
+						scalar_visible = total_visible;
+						reference = visible;
+					}
+					else if (total_visible != scalar_visible || visible != reference)
+						throw std::runtime_error(std::string(cullPathName(path)) + " culling disagrees with the scalar one");
+
+					std::cout << std::fixed << std::setprecision(3)
+					          << std::setw(8) << (volume == 0 ? "sphere" : "box")
+					          << std::setw(8) << cullPathName(path)
+					          << std::setw(9) << workers
+					          << std::setw(12) << ms
+					          << std::setw(16) << 1e6 * ms / object_count
+					          << std::setw(11) << std::setprecision(1) << 100.0 * total_visible / frames / object_count << "%"
+					          << std::setw(9) << scalar_ms / ms << "x" << std::endl;
+				}
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (...)
+	{
+		std::cout << "unknown exception" << std::endl;
+		return -128;
+	}
+
+	return 0;
+}
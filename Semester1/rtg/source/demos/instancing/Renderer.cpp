@@ -0,0 +1,143 @@
+
+
+
+#include <cmath>
+#include <iostream>
+
+#include <framework/parallel.h>
+#include <framework/math/camera.h>
+#include <framework/instrumentation/profiler.h>
+
+#include "Renderer.h"
+#include "benchmark.h"
+
+
+namespace
+{
+	const char* desert_file = "../assets/desert.obj";
+	const char* palmtree_file = "../assets/palmtree.obj";
+
+	const float fov = 3.14159265f / 3.0f;
+	const float near_plane = 0.1f;
+	const float far_plane = 100.0f;
+	const float lod_threshold_pixels = 1.0f;
+
+	// frames between two culling reports
+	const unsigned int report_frames = 300;
+}
+
+Renderer::Renderer(GL::platform::Window& window, std::size_t palmtree_count)
+	: BasicRenderer(window, 3, 3),
+	  viewport_width(800),
+	  viewport_height(600),
+	  programs("shader_cache"),
+	  frame_uniforms(createBuffer(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW)),
+	  culling_workers(parallel::hardwareThreads()),
+	  culled_in_frustum(0),
+	  culled_visible(0),
+	  culling_ms(0.0),
+	  frame_zone_id(gpu_profiler.zone("frame")),
+	  desert_zone_id(gpu_profiler.zone("desert")),
+	  palmtree_zone_id(gpu_profiler.zone("palmtrees")),
+	  frame(0)
+{
+	glClearColor(0.55f, 0.75f, 0.95f, 1.0f);
+	glEnable(GL_DEPTH_TEST);
+
+	CachedMesh desert_mesh = loadCachedMesh(desert_file);
+	CachedMesh palmtree_mesh = loadCachedMesh(palmtree_file);
+
+	desert.reset(new SceneMesh(desert_mesh));
+	palmtree.reset(new SceneMesh(palmtree_mesh));
+	ground.reset(new HeightField(desert_mesh, 64));
+
+	// the desert is a single instance, in the color of sand
+	desert->instances.update(std::vector<Instance>(1, makeInstance(math::identity<math::float4x4>(), math::float4(0.85f, 0.7f, 0.45f, 1.0f))));
+	palmtrees = scatterPalmtrees(*ground, *palmtree, palmtree_count, 1);
+	culling.reset(new PalmtreeCulling(desert_mesh, *palmtree, palmtrees));
+
+	program = programs.get(vertex_shader_src, fragment_shader_src);
+	bindUniformBlock(program, "Frame", frame_binding);
+	glBindBufferBase(GL_UNIFORM_BUFFER, frame_binding, frame_uniforms);
+
+	std::cout << palmtree->instances.size() << " palmtrees, LODs of";
+	for (const MeshLod& lod : palmtree->lods)
+		std::cout << " " << lod.index_count / 3;
+	std::cout << " triangles, " << culling->occluderTriangles() << " occluder triangles" << std::endl;
+
+	window.attach(this);
+}
+
+void Renderer::benchmark()
+{
+	glUseProgram(program);
+	setFrameUniforms(frame_uniforms, math::look_at(math::float3(0.0f, 4.0f, 9.0f), math::float3(0.0f, 0.0f, 0.0f), math::float3(0.0f, 1.0f, 0.0f)),
+	                                 math::perspective(fov, 4.0f / 3.0f, near_plane, far_plane));
+	benchmarkDrawCalls(*palmtree, *ground, std::cout);
+	std::cout << std::endl;
+	benchmarkCulling(loadCachedMesh(desert_file), *palmtree, *ground, std::cout);
+}
+
+void Renderer::resize(int width, int height)
+{
+	viewport_width = width;
+	viewport_height = height;
+}
+
+void Renderer::render()
+{
+	PROFILE_ZONE("render");
+
+	gpu_profiler.beginFrame();
+	gpu_profiler.begin(frame_zone_id);
+
+	glViewport(0, 0, viewport_width, viewport_height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// circle the desert slowly
+	float angle = 0.002f * frame;
+	math::float3 camera = cameraPosition(angle);
+	math::float4x4 view = math::look_at(camera, camera_target, math::float3(0.0f, 1.0f, 0.0f));
+	math::float4x4 projection = math::perspective(fov, float(viewport_width) / float(viewport_height), near_plane, far_plane);
+
+	// only the trees that survive culling go to the GL
+	const std::vector<std::uint32_t>& visible = culling->cull(projection * view, culling_workers);
+	visible_palmtrees.resize(visible.size());
+	for (std::size_t i = 0; i < visible.size(); ++i)
+		visible_palmtrees[i] = palmtrees[visible[i]];
+	palmtree->instances.update(visible_palmtrees);
+
+	culled_in_frustum += culling->inFrustum();
+	culled_visible += visible.size();
+	culling_ms += culling->frustumTime() + culling->rasterizeTime() + culling->testTime();
+
+	glUseProgram(program);
+	setFrameUniforms(frame_uniforms, view, projection);
+
+	{
+		GPUZone zone(gpu_profiler, desert_zone_id);
+		desert->draw(0);
+	}
+
+	// the trees are small and far apart, one LOD for all of them picked at the distance to the center
+	float pixels = pixelsPerUnit(0.03f, length(camera), fov, viewport_height);
+	{
+		GPUZone zone(gpu_profiler, palmtree_zone_id);
+		palmtree->draw(palmtree_lod.select(palmtree->lods.data(), palmtree->lods.size(), pixels, lod_threshold_pixels));
+	}
+
+	gpu_profiler.end(frame_zone_id);
+	gpu_profiler.endFrame();
+
+	swapBuffers();
+
+	if (++frame % report_frames == 0)
+	{
+		std::cout << "culling: " << culled_visible / report_frames << " of " << culled_in_frustum / report_frames
+		          << " palmtrees in view visible, " << culling_ms / report_frames << " ms per frame" << std::endl;
+		culled_in_frustum = culled_visible = 0;
+		culling_ms = 0.0;
+
+		gpu_profiler.report(std::cout);
+	}
+}
@@ -0,0 +1,70 @@
+
+
+
+#ifndef INCLUDED_INSTANCING_RENDERER
+#define INCLUDED_INSTANCING_RENDERER
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <GL/platform/Window.h>
+
+#include <framework/BasicRenderer.h>
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
+#include <framework/mesh_lod.h>
+#include <framework/gpu_profiler.h>
+
+#include "scene.h"
+#include "palmtree_culling.h"
+
+
+// a desert with palmtrees on it, every mesh drawn with one instanced draw call; the trees hidden by
+// the dunes are culled on the CPU before that
+class Renderer : public BasicRenderer
+{
+private:
+	int viewport_width;
+	int viewport_height;
+
+	ProgramCache programs;
+	GLuint program;
+	Buffer frame_uniforms;
+
+	std::unique_ptr<SceneMesh> desert;
+	std::unique_ptr<SceneMesh> palmtree;
+	std::unique_ptr<HeightField> ground;
+	LodSelector palmtree_lod;
+
+	std::vector<Instance> palmtrees;
+	std::vector<Instance> visible_palmtrees;
+	std::unique_ptr<PalmtreeCulling> culling;
+	unsigned int culling_workers;
+
+	// summed up since the last report
+	std::size_t culled_in_frustum;
+	std::size_t culled_visible;
+	double culling_ms;
+
+	// GPU time of the whole frame and of each mesh, printed with the culling and when the demo ends
+	GPUProfiler gpu_profiler;
+	std::size_t frame_zone_id;
+	std::size_t desert_zone_id;
+	std::size_t palmtree_zone_id;
+
+	unsigned int frame;
+
+public:
+	Renderer(GL::platform::Window& window, std::size_t palmtree_count);
+
+	// draw calls against instancing and the cost of culling, printed to std::cout
+	void benchmark();
+
+	void resize(int width, int height);
+	void render();
+};
+
+#endif  // INCLUDED_INSTANCING_RENDERER
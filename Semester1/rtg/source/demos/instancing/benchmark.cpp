@@ -0,0 +1,154 @@
+
+
+
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <ostream>
+
+#include <framework/parallel.h>
+#include <framework/math/camera.h>
+#include <framework/timing.h>
+
+#include "palmtree_culling.h"
+#include "benchmark.h"
+
+
+namespace
+{
+	const std::size_t object_counts[] = { 1, 10, 100, 1000, 10000 };
+	const int frames = 20;
+
+	const std::size_t culled_palmtrees = 10000;
+	const int lap_frames = 60;
+
+	struct Timing
+	{
+		double submit_ms;  // issuing the calls
+		double frame_ms;   // including glFinish
+	};
+
+	// the old way: the transform of each tree set as constant attributes, then a draw call of its own
+	Timing submitSeparately(const SceneMesh& mesh, const MeshLod& lod, const std::vector<Instance>& instances)
+	{
+		glBindVertexArray(mesh.vao);
+		for (GLuint i = 0; i < InstanceFormat::location_count; ++i)
+			glDisableVertexAttribArray(instance_location + i);
+
+		Timing t = { 0.0, 0.0 };
+		for (int f = 0; f < frames; ++f)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (const Instance& instance : instances)
+			{
+				glVertexAttrib4fv(instance_location + 0, &instance.transform._11);
+				glVertexAttrib4fv(instance_location + 1, &instance.transform._21);
+				glVertexAttrib4fv(instance_location + 2, &instance.transform._31);
+				glVertexAttrib4fv(instance_location + 3, &instance.color.x);
+				glDrawElements(GL_TRIANGLES, lod.index_count, mesh.index_type, reinterpret_cast<const void*>(lod.index_offset * mesh.index_size));
+			}
+			t.submit_ms += millisecondsSince(start);
+			glFinish();
+			t.frame_ms += millisecondsSince(start);
+		}
+
+		for (GLuint i = 0; i < InstanceFormat::location_count; ++i)
+			glEnableVertexAttribArray(instance_location + i);
+
+		return t;
+	}
+
+	// all trees uploaded and drawn at once, every frame as if they had moved
+	Timing submitInstanced(SceneMesh& mesh, const MeshLod& lod, const std::vector<Instance>& instances)
+	{
+		Timing t = { 0.0, 0.0 };
+		for (int f = 0; f < frames; ++f)
+		{
+			auto start = std::chrono::steady_clock::now();
+			mesh.instances.update(instances);
+			glBindVertexArray(mesh.vao);
+			drawInstanced(mesh.instances, lod.index_count, mesh.index_type, lod.index_offset * mesh.index_size);
+			t.submit_ms += millisecondsSince(start);
+			glFinish();
+			t.frame_ms += millisecondsSince(start);
+		}
+		return t;
+	}
+}
+
+void benchmarkDrawCalls(SceneMesh& palmtree, const HeightField& ground, std::ostream& out)
+{
+	// one triangle of each tree and no rasterization, so what is measured is the cost of issuing the
+	// calls rather than the vertex work behind them, which a software rasterizer does right in the call
+	MeshLod triangle = { palmtree.lods.back().index_offset, 3, 0.0f };
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	out << "one palmtree triangle per tree, average of " << frames << " frames" << std::endl;
+	out << std::setw(8) << "trees" << std::setw(16) << "draw calls ms" << std::setw(14) << "us per call"
+	    << std::setw(14) << "instanced ms" << std::setw(10) << "speedup" << std::setw(16) << "frame ms (d/i)" << std::endl;
+
+	for (std::size_t count : object_counts)
+	{
+		std::vector<Instance> instances = scatterPalmtrees(ground, palmtree, count, 1);
+
+		// once each to warm up
+		submitSeparately(palmtree, triangle, std::vector<Instance>(instances.begin(), instances.begin() + 1));
+		submitInstanced(palmtree, triangle, instances);
+
+		Timing separate = submitSeparately(palmtree, triangle, instances);
+		Timing instanced = submitInstanced(palmtree, triangle, instances);
+
+		out << std::fixed << std::setprecision(3)
+		    << std::setw(8) << count
+		    << std::setw(16) << separate.submit_ms / frames
+		    << std::setw(14) << 1000.0 * separate.submit_ms / frames / count
+		    << std::setw(14) << instanced.submit_ms / frames
+		    << std::setw(9) << std::setprecision(1) << separate.submit_ms / instanced.submit_ms << "x" << std::setprecision(2)
+		    << std::setw(9) << separate.frame_ms / frames << " / " << instanced.frame_ms / frames << std::endl;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+void benchmarkCulling(const CachedMesh& desert, const SceneMesh& palmtree, const HeightField& ground, std::ostream& out)
+{
+	std::vector<Instance> palmtrees = scatterPalmtrees(ground, palmtree, culled_palmtrees, 1);
+	PalmtreeCulling culling(desert, palmtree, palmtrees);
+
+	unsigned int threads = parallel::hardwareThreads();
+	std::vector<unsigned int> worker_counts(1, 1U);
+	worker_counts.push_back(std::max(threads, 2U));
+
+	out << culling.size() << " palmtrees, " << culling.occluderTriangles() << " occluder triangles, average of a " << lap_frames
+	    << " frame lap, " << threads << " hardware threads" << std::endl;
+	out << std::setw(8) << "threads" << std::setw(12) << "in frustum" << std::setw(10) << "visible" << std::setw(12) << "occluded"
+	    << std::setw(12) << "frustum ms" << std::setw(14) << "rasterize ms" << std::setw(10) << "test ms" << std::setw(10) << "total ms" << std::endl;
+
+	math::float4x4 projection = math::perspective(3.14159265f / 3.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+	for (unsigned int workers : worker_counts)
+	{
+		double in_frustum = 0.0, visible = 0.0, frustum_ms = 0.0, rasterize_ms = 0.0, test_ms = 0.0;
+
+		for (int f = 0; f < lap_frames; ++f)
+		{
+			math::float3 camera = cameraPosition(2.0f * 3.14159265f * f / lap_frames);
+			visible += culling.cull(projection * math::look_at(camera, camera_target, math::float3(0.0f, 1.0f, 0.0f)), workers).size();
+			in_frustum += culling.inFrustum();
+			frustum_ms += culling.frustumTime();
+			rasterize_ms += culling.rasterizeTime();
+			test_ms += culling.testTime();
+		}
+
+		out << std::fixed << std::setprecision(0)
+		    << std::setw(8) << workers
+		    << std::setw(12) << in_frustum / lap_frames
+		    << std::setw(10) << visible / lap_frames
+		    << std::setw(11) << std::setprecision(1) << 100.0 * (1.0 - visible / in_frustum) << "%"
+		    << std::setprecision(3)
+		    << std::setw(12) << frustum_ms / lap_frames
+		    << std::setw(14) << rasterize_ms / lap_frames
+		    << std::setw(10) << test_ms / lap_frames
+		    << std::setw(10) << (frustum_ms + rasterize_ms + test_ms) / lap_frames << std::endl;
+	}
+}
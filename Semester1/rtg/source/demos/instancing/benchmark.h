@@ -0,0 +1,23 @@
+
+
+
+#ifndef INCLUDED_INSTANCING_BENCHMARK
+#define INCLUDED_INSTANCING_BENCHMARK
+
+#pragma once
+
+#include <iosfwd>
+
+#include "scene.h"
+
+
+// CPU time per frame to submit the palmtrees once with a draw call per tree and once with one
+// instanced draw call, for growing numbers of trees; needs the program bound and the frame uniforms
+// in place, only the GL context, not a window
+void benchmarkDrawCalls(SceneMesh& palmtree, const HeightField& ground, std::ostream& out);
+
+// how many palmtrees the frustum and the dunes hide on a lap of the camera, and what finding that
+// out costs on the CPU, on one and on all hardware threads; no GL involved
+void benchmarkCulling(const CachedMesh& desert, const SceneMesh& palmtree, const HeightField& ground, std::ostream& out);
+
+#endif  // INCLUDED_INSTANCING_BENCHMARK
@@ -0,0 +1,13 @@
+
+
+
+#include <framework/demo.h>
+
+#include "Renderer.h"
+
+
+// instancing [palmtrees] | instancing --benchmark
+int main(int argc, char* argv[])
+{
+	return runDemo<Renderer>(argc, argv, "Instancing — palmtrees in the desert", 2000);
+}
@@ -0,0 +1,77 @@
+
+
+
+#include <chrono>
+#include <algorithm>
+
+#include <framework/timing.h>
+
+#include "palmtree_culling.h"
+
+
+namespace
+{
+	// the depth buffer the dunes are drawn into, and how coarse they may get for it
+	const int occlusion_width = 320;
+	const int occlusion_height = 180;
+	const std::size_t max_occluder_triangles = 4000;
+}
+
+PalmtreeCulling::PalmtreeCulling(const CachedMesh& desert, const SceneMesh& palmtree, const std::vector<Instance>& palmtrees)
+	: occluder_vertices(desert.vertices(), desert.vertices() + desert.vertexCount()),
+	  occlusion(occlusion_width, occlusion_height),
+	  frustum_ms(0.0),
+	  rasterize_ms(0.0),
+	  test_ms(0.0)
+{
+	// the finest LOD within the budget, or the coarsest there is
+	std::size_t lod = 0;
+	while (lod + 1 < desert.lodCount() && desert.lod(lod).index_count / 3 > max_occluder_triangles)
+		++lod;
+
+	const MeshLod& range = desert.lod(lod);
+	occluder_indices.resize(range.index_count);
+	for (std::size_t i = 0; i < range.index_count; ++i)
+		occluder_indices[i] = desert.indexSize() == 2
+			? static_cast<const std::uint16_t*>(desert.indices())[range.index_offset + i]
+			: static_cast<const std::uint32_t*>(desert.indices())[range.index_offset + i];
+
+	// the box around each tree in the world, from the corners of its mesh's box
+	bounds.reserve(palmtrees.size());
+	for (const Instance& instance : palmtrees)
+	{
+		const math::float3x4& m = instance.transform;
+		math::float3 lo(1e30f, 1e30f, 1e30f), hi(-1e30f, -1e30f, -1e30f);
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			math::float3 p((corner & 1) ? palmtree.bbox_max.x : palmtree.bbox_min.x,
+			               (corner & 2) ? palmtree.bbox_max.y : palmtree.bbox_min.y,
+			               (corner & 4) ? palmtree.bbox_max.z : palmtree.bbox_min.z);
+			math::float3 w(m._11 * p.x + m._12 * p.y + m._13 * p.z + m._14,
+			               m._21 * p.x + m._22 * p.y + m._23 * p.z + m._24,
+			               m._31 * p.x + m._32 * p.y + m._33 * p.z + m._34);
+			lo = math::float3(std::min(lo.x, w.x), std::min(lo.y, w.y), std::min(lo.z, w.z));
+			hi = math::float3(std::max(hi.x, w.x), std::max(hi.y, w.y), std::max(hi.z, w.z));
+		}
+		bounds.push_back(lo, hi);
+	}
+}
+
+const std::vector<std::uint32_t>& PalmtreeCulling::cull(const math::float4x4& view_projection, unsigned int workers)
+{
+	auto start = std::chrono::steady_clock::now();
+	cullBoxes(math::extract_frustum(view_projection), bounds, in_frustum, workers);
+	frustum_ms = millisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	occlusion.begin(view_projection);
+	occlusion.addOccluder(math::identity<math::float4x4>(), occluder_vertices.data(), occluder_indices.data(), occluder_indices.size());
+	occlusion.rasterize(workers);
+	rasterize_ms = millisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	occlusion.test(bounds, in_frustum, visible, workers);
+	test_ms = millisecondsSince(start);
+
+	return visible;
+}
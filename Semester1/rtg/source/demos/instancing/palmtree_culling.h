@@ -0,0 +1,55 @@
+
+
+
+#ifndef INCLUDED_INSTANCING_PALMTREE_CULLING
+#define INCLUDED_INSTANCING_PALMTREE_CULLING
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <framework/mesh.h>
+#include <framework/mesh_cache.h>
+#include <framework/culling.h>
+#include <framework/occlusion.h>
+#include <framework/instancing.h>
+
+#include "scene.h"
+
+
+// the palmtrees that are in view and not hidden behind the dunes: the frustum first, then the
+// bounding boxes of what is left against a coarse LOD of the desert in a software depth buffer
+class PalmtreeCulling
+{
+private:
+	std::vector<Vertex> occluder_vertices;
+	std::vector<std::uint32_t> occluder_indices;
+	OcclusionBuffer occlusion;
+
+	BoundingBoxes bounds;
+	std::vector<std::uint32_t> in_frustum;
+	std::vector<std::uint32_t> visible;
+
+	double frustum_ms;
+	double rasterize_ms;
+	double test_ms;
+
+public:
+	PalmtreeCulling(const CachedMesh& desert, const SceneMesh& palmtree, const std::vector<Instance>& palmtrees);
+
+	// the indices of the visible palmtrees, in ascending order
+	const std::vector<std::uint32_t>& cull(const math::float4x4& view_projection, unsigned int workers = 1);
+
+	// of the last cull()
+	std::size_t inFrustum() const { return in_frustum.size(); }
+	double frustumTime() const { return frustum_ms; }
+	double rasterizeTime() const { return rasterize_ms; }
+	double testTime() const { return test_ms; }
+
+	std::size_t occluderTriangles() const { return occluder_indices.size() / 3; }
+	std::size_t size() const { return bounds.size(); }
+};
+
+#endif  // INCLUDED_INSTANCING_PALMTREE_CULLING
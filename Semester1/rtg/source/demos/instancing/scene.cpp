@@ -0,0 +1,202 @@
+
+
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include "scene.h"
+
+
+namespace
+{
+	GLenum indexType(std::size_t index_size)
+	{
+		switch (index_size)
+		{
+		case 1:
+			return GL_UNSIGNED_BYTE;
+		case 2:
+			return GL_UNSIGNED_SHORT;
+		default:
+			return GL_UNSIGNED_INT;
+		}
+	}
+}
+
+SceneMesh::SceneMesh(const CachedMesh& mesh)
+	: vao(createVertexArray()),
+	  index_type(indexType(mesh.indexSize())),
+	  index_size(mesh.indexSize()),
+	  lods(mesh.lods(), mesh.lods() + mesh.lodCount()),
+	  bbox_min(mesh.bboxMin()),
+	  bbox_max(mesh.bboxMax())
+{
+	glBindVertexArray(vao);
+
+	vertices = createBuffer(GL_ARRAY_BUFFER, MeshVertexFormat::stride * mesh.vertexCount(), mesh.vertices());
+	MeshVertexFormat::configure();
+
+	indices = createBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexSize() * mesh.indexCount(), mesh.indices());
+
+	instances.attach(instance_location);
+
+	glBindVertexArray(0);
+}
+
+void SceneMesh::draw(std::size_t lod) const
+{
+	const MeshLod& range = lods[std::min(lod, lods.size() - 1)];
+
+	glBindVertexArray(vao);
+	drawInstanced(instances, range.index_count, index_type, range.index_offset * index_size);
+}
+
+
+HeightField::HeightField(const CachedMesh& ground, int resolution)
+	: resolution(resolution),
+	  bbox_min(ground.bboxMin()),
+	  bbox_max(ground.bboxMax()),
+	  heights(resolution * resolution, 0.0f)
+{
+	std::vector<int> samples(heights.size(), 0);
+
+	float sx = resolution / (bbox_max.x - bbox_min.x);
+	float sz = resolution / (bbox_max.z - bbox_min.z);
+
+	for (std::size_t i = 0; i < ground.vertexCount(); ++i)
+	{
+		const math::float3& p = ground.vertices()[i].position;
+		int x = std::min(static_cast<int>((p.x - bbox_min.x) * sx), resolution - 1);
+		int z = std::min(static_cast<int>((p.z - bbox_min.z) * sz), resolution - 1);
+		heights[z * resolution + x] += p.y;
+		++samples[z * resolution + x];
+	}
+
+	// cells without a vertex get the average of the ground
+	float total = 0.0f;
+	int filled = 0;
+	for (std::size_t i = 0; i < heights.size(); ++i)
+		if (samples[i])
+		{
+			heights[i] /= samples[i];
+			total += heights[i];
+			++filled;
+		}
+
+	for (std::size_t i = 0; i < heights.size(); ++i)
+		if (!samples[i])
+			heights[i] = filled ? total / filled : 0.0f;
+}
+
+float HeightField::height(float x, float z) const
+{
+	// bilinear between the cell centers
+	float u = (x - bbox_min.x) / (bbox_max.x - bbox_min.x) * resolution - 0.5f;
+	float v = (z - bbox_min.z) / (bbox_max.z - bbox_min.z) * resolution - 0.5f;
+	u = std::max(0.0f, std::min(u, resolution - 1.0f));
+	v = std::max(0.0f, std::min(v, resolution - 1.0f));
+
+	int x0 = std::min(static_cast<int>(u), resolution - 2);
+	int z0 = std::min(static_cast<int>(v), resolution - 2);
+	float fu = u - x0, fv = v - z0;
+
+	const float* row0 = &heights[z0 * resolution];
+	const float* row1 = row0 + resolution;
+
+	return (row0[x0] * (1.0f - fu) + row0[x0 + 1] * fu) * (1.0f - fv) +
+	       (row1[x0] * (1.0f - fu) + row1[x0 + 1] * fu) * fv;
+}
+
+
+math::float3 cameraPosition(float angle)
+{
+	return math::float3(3.5f * std::sin(angle), 0.35f, 3.5f * std::cos(angle));
+}
+
+
+std::vector<Instance> scatterPalmtrees(const HeightField& ground, const SceneMesh& palmtree, std::size_t count, unsigned int seed)
+{
+	std::mt19937 random(seed);
+
+	// keep clear of the edge, the trees are wider than their trunk
+	math::float3 margin = (ground.max() - ground.min()) * 0.05f;
+	std::uniform_real_distribution<float> x(ground.min().x + margin.x, ground.max().x - margin.x);
+	std::uniform_real_distribution<float> z(ground.min().z + margin.z, ground.max().z - margin.z);
+	std::uniform_real_distribution<float> scale(0.02f, 0.04f);
+	std::uniform_real_distribution<float> yaw(0.0f, 2.0f * 3.14159265f);
+	std::uniform_real_distribution<float> tint(0.0f, 1.0f);
+
+	std::vector<Instance> instances;
+	instances.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		float px = x(random), pz = z(random), s = scale(random), a = yaw(random), t = tint(random);
+		float c = std::cos(a) * s, sn = std::sin(a) * s;
+
+		// the root of the tree on the ground, which is where the bottom of its bounding box goes
+		float py = ground.height(px, pz) - palmtree.bbox_min.y * s;
+
+		instances.push_back(Instance {
+			math::float3x4(   c, 0.0f,   sn, px,
+			               0.0f,    s, 0.0f, py,
+			                -sn, 0.0f,    c, pz),
+			math::float4(0.25f + 0.2f * t, 0.55f + 0.15f * t, 0.15f, 1.0f)
+		});
+	}
+
+	return instances;
+}
+
+
+const char* vertex_shader_src = R"(
+#version 330
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 3) in vec4 transformRow0;
+layout(location = 4) in vec4 transformRow1;
+layout(location = 5) in vec4 transformRow2;
+layout(location = 6) in vec4 instanceColor;
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+out vec3 worldNormal;
+out vec4 color;
+
+void main()
+{
+	mat4 model = transpose(mat4(transformRow0, transformRow1, transformRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+	gl_Position = Projection * View * model * vec4(position, 1.0);
+	worldNormal = mat3(model) * normal;
+	color = instanceColor;
+}
+)";
+
+const char* fragment_shader_src = R"(
+#version 330
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+in vec3 worldNormal;
+in vec4 color;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+	float lambert = max(dot(normalize(worldNormal), LightDirection.xyz), 0.0);
+	fragColor = vec4(color.rgb * (0.35 + 0.65 * lambert), color.a);
+}
+)";
@@ -0,0 +1,77 @@
+
+
+
+#ifndef INCLUDED_INSTANCING_SCENE
+#define INCLUDED_INSTANCING_SCENE
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include <framework/math/vector.h>
+#include <framework/mesh.h>
+#include <framework/mesh_lod.h>
+#include <framework/mesh_cache.h>
+#include <framework/gl_objects.h>
+#include <framework/vertex_format.h>
+#include <framework/geometry_pool.h>
+#include <framework/instancing.h>
+#include <framework/frame_uniforms.h>
+
+
+const GLuint frame_binding = 0;
+
+// the instance attributes follow the vertex attributes
+const GLuint instance_location = MeshVertexFormat::location_count;
+
+// a mesh with all its LODs and the copies of it that are drawn
+struct SceneMesh
+{
+	VertexArray vao;
+	Buffer vertices;
+	Buffer indices;
+	GLenum index_type;
+	std::size_t index_size;
+	std::vector<MeshLod> lods;
+	math::float3 bbox_min;
+	math::float3 bbox_max;
+	InstanceBuffer instances;
+
+	explicit SceneMesh(const CachedMesh& mesh);
+
+	// all instances with one draw call
+	void draw(std::size_t lod) const;
+};
+
+// heights of the ground on a regular grid over its bounding box, from the vertices that fall into each cell
+class HeightField
+{
+private:
+	int resolution;
+	math::float3 bbox_min;
+	math::float3 bbox_max;
+	std::vector<float> heights;
+
+public:
+	HeightField(const CachedMesh& ground, int resolution);
+
+	float height(float x, float z) const;
+
+	math::float3 min() const { return bbox_min; }
+	math::float3 max() const { return bbox_max; }
+};
+
+// the camera circles the desert low above the dunes, so that they hide some of the trees
+math::float3 cameraPosition(float angle);
+const math::float3 camera_target(0.0f, 0.3f, 0.0f);
+
+// count palmtrees standing on the ground, scaled, turned and tinted at random
+std::vector<Instance> scatterPalmtrees(const HeightField& ground, const SceneMesh& palmtree, std::size_t count, unsigned int seed);
+
+extern const char* vertex_shader_src;
+extern const char* fragment_shader_src;
+
+#endif  // INCLUDED_INSTANCING_SCENE
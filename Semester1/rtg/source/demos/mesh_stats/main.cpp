@@ -0,0 +1,111 @@
+
+
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <framework/obj.h>
+#include <framework/mesh.h>
+#include <framework/mesh_cache.h>
+#include <framework/mesh_optimize.h>
+#include <framework/mesh_quantize.h>
+#include <framework/mesh_lod.h>
+#include <framework/timing.h>
+
+
+namespace
+{
+	const char* default_assets[] = {
+		"assets/cube.obj",
+		"assets/nukahedron.obj",
+		"assets/vader.obj",
+		"assets/palmtree.obj",
+		"assets/desert.obj"
+	};
+
+	// how task4 frames its model: scaled by 0.15, 1.5 units in front of a 60 degree camera, 720 pixels high
+	const float scene_scale = 0.15f;
+	const float scene_distance = 1.5f;
+	const float scene_fov = 3.14159265f / 3.0f;
+	const int scene_height = 720;
+
+	void report(const char* filename)
+	{
+		auto start = std::chrono::steady_clock::now();
+		OBJ::Mesh obj = OBJ::loadMesh(filename);
+		IndexedMesh mesh = buildIndexedMesh(obj, true);
+		double build_ms = millisecondsSince(start);
+
+		VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+		start = std::chrono::steady_clock::now();
+		optimizeMesh(mesh);
+		double optimize_ms = millisecondsSince(start);
+		VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+		// the first call may have to write the cache, the second one is what every later run sees
+		loadCachedMesh(filename, true);
+		start = std::chrono::steady_clock::now();
+		CachedMesh cached = loadCachedMesh(filename, true);
+		double cache_ms = millisecondsSince(start);
+
+		QuantizedMesh quantized = quantizeVertices(mesh.vertices.data(), mesh.vertices.size());
+		QuantizationError error = measureQuantizationError(mesh.vertices.data(), quantized);
+
+		std::size_t corners = mesh.indices.size();
+		std::size_t expanded_bytes = corners * sizeof(Vertex);
+		std::size_t indexed_bytes = mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * mesh.indexSize();
+
+		std::cout << filename << ": " << mesh.triangleCount() << " triangles" << std::endl;
+		std::cout << std::fixed << std::setprecision(1);
+		std::cout << "  vertices: " << corners << " expanded -> " << mesh.vertices.size() << " unique ("
+		          << 100.0 * (1.0 - static_cast<double>(mesh.vertices.size()) / corners) << "% fewer), "
+		          << mesh.indexSize() * 8 << "-bit indices" << std::endl;
+		std::cout << "  memory:   " << expanded_bytes / 1024.0 << " KiB expanded -> " << indexed_bytes / 1024.0 << " KiB indexed ("
+		          << (static_cast<double>(expanded_bytes) - indexed_bytes) / 1024.0 << " KiB saved)" << std::endl;
+		std::cout << "  quantize: " << sizeof(Vertex) << " -> " << sizeof(QuantizedVertex) << " bytes/vertex, max error position "
+		          << std::scientific << std::setprecision(2) << error.position << " (" << error.position_relative << " of diagonal), normal "
+		          << error.normal_degrees << " deg, uv " << error.texcoord << std::fixed << std::endl;
+		std::cout << "  lods:    ";
+		for (std::size_t i = 0; i < cached.lodCount(); ++i)
+			std::cout << " " << cached.lod(i).index_count / 3 << " (" << std::setprecision(4) << cached.lod(i).error << ")";
+		std::cout << std::endl;
+
+		LodSelector selector;
+		const MeshLod& lod = cached.lod(selector.select(cached.lods(), cached.lodCount(),
+			pixelsPerUnit(scene_scale, scene_distance, scene_fov, scene_height)));
+		std::cout << std::setprecision(1) << "  task4:    LOD " << selector.lod() << " at 1 px, " << lod.index_count / 3 << " of " << mesh.triangleCount()
+		          << " triangles (" << 100.0 * (1.0 - static_cast<double>(lod.index_count) / mesh.indices.size()) << "% saved)" << std::endl;
+		std::cout << std::setprecision(3);
+		std::cout << "  vcache:   ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr
+		          << " (FIFO 16, optimized in " << optimize_ms << " ms)" << std::endl;
+		std::cout << "  load:     " << build_ms << " ms parse+index -> " << cache_ms << " ms "
+		          << (cached.mapped() ? "mapped from " : "built, not cached in ") << meshCacheFilename(filename) << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		if (argc > 1)
+			for (int i = 1; i < argc; ++i)
+				report(argv[i]);
+		else
+			for (const char* filename : default_assets)
+				report(filename);
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (...)
+	{
+		std::cout << "unknown exception" << std::endl;
+		return -128;
+	}
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+
+
+
+#include <cmath>
+#include <iostream>
+
+#include <framework/math/camera.h>
+#include <framework/instrumentation/profiler.h>
+
+#include "Renderer.h"
+#include "benchmark.h"
+
+
+namespace
+{
+	const float fov = 3.14159265f / 3.0f;
+	const float near_plane = 0.1f;
+	const float far_plane = 500.0f;
+	const float lod_threshold_pixels = 1.0f;
+	const float spacing = 1.0f;
+	const unsigned int report_frames = 300;
+}
+
+Renderer::Renderer(GL::platform::Window& window, std::size_t object_count)
+	: BasicRenderer(window, 4, 3),
+	  viewport_width(800),
+	  viewport_height(600),
+	  programs("shader_cache"),
+	  frame_uniforms(createBuffer(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW)),
+	  frame(0)
+{
+	glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+	glEnable(GL_DEPTH_TEST);
+
+	// everything goes into the pool before it is uploaded in one piece
+	for (std::size_t i = 0; i < mesh_file_count; ++i)
+	{
+		meshes.push_back(loadCachedMesh(mesh_files[i]));
+		pool.add(meshes.back());
+	}
+	pool.upload();
+
+	objects = scatterObjects(pool, object_count, spacing, 1);
+	lods.resize(objects.size());
+
+	// the objects spin about their center, so their spheres stay where they are
+	bounds.reserve(objects.size());
+	for (const GridObject& object : objects)
+	{
+		const PooledMesh& mesh = pool.mesh(object.mesh);
+		bounds.push_back(object.position, 0.5f * object.scale * length(mesh.bbox_max - mesh.bbox_min));
+	}
+	extent = spacing * std::sqrt(static_cast<float>(objects.size()));
+
+	std::string vertex_shader = batchVertexShader(pool);
+	program = programs.get(vertex_shader.c_str(), fragment_shader_src);
+	bindUniformBlock(program, "Frame", frame_binding);
+	glBindBufferBase(GL_UNIFORM_BUFFER, frame_binding, frame_uniforms);
+
+	std::cout << objects.size() << " objects out of a pool of " << pool.meshCount() << " meshes, " << pool.vertexCount() << " vertices, "
+	          << pool.indexCount() << " indices; draw index from " << (pool.drawParameters() ? "gl_DrawIDARB" : "the base instance") << std::endl;
+
+	window.attach(this);
+}
+
+void Renderer::benchmark()
+{
+	setFrameUniforms(frame_uniforms, math::look_at(math::float3(0.0f, 0.6f * extent, 0.8f * extent), math::float3(0.0f, 0.0f, 0.0f), math::float3(0.0f, 1.0f, 0.0f)),
+	                                 math::perspective(fov, 4.0f / 3.0f, near_plane, far_plane));
+	benchmarkDrawCalls(pool, meshes, programs, std::cout);
+}
+
+void Renderer::resize(int width, int height)
+{
+	viewport_width = width;
+	viewport_height = height;
+}
+
+void Renderer::render()
+{
+	PROFILE_ZONE("render");
+
+	glViewport(0, 0, viewport_width, viewport_height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// circle the grid slowly
+	float angle = 0.002f * frame;
+	math::float3 camera(0.8f * extent * std::sin(angle), 0.6f * extent, 0.8f * extent * std::cos(angle));
+
+	math::float4x4 view = math::look_at(camera, math::float3(0.0f, 0.0f, 0.0f), math::float3(0.0f, 1.0f, 0.0f));
+	math::float4x4 projection = math::perspective(fov, float(viewport_width) / float(viewport_height), near_plane, far_plane);
+
+	glUseProgram(program);
+	setFrameUniforms(frame_uniforms, view, projection);
+
+	// only what is in view goes into the batch
+	cullSpheres(math::extract_frustum(projection * view), bounds, visible);
+
+	// the draws are rebuilt every frame: the objects spin and their LODs follow the camera
+	float time = frame / 60.0f;
+	std::size_t triangles = 0;
+	batch.clear();
+	for (std::uint32_t i : visible)
+	{
+		const PooledMesh& mesh = pool.mesh(objects[i].mesh);
+		float pixels = pixelsPerUnit(objects[i].scale, length(objects[i].position - camera), fov, viewport_height);
+		std::size_t lod = lods[i].select(mesh.lods.data(), mesh.lods.size(), pixels, lod_threshold_pixels);
+
+		batch.add(mesh, lod, objectInstance(pool, objects[i], time));
+		triangles += mesh.lods[lod].index_count / 3;
+	}
+	batch.upload(pool);
+	batch.submit(pool, draws_binding);
+
+	if (frame % report_frames == 0)
+		std::cout << batch.size() << " of " << objects.size() << " objects visible, " << triangles << " triangles in one call" << std::endl;
+
+	swapBuffers();
+	++frame;
+}
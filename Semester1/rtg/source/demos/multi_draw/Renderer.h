@@ -0,0 +1,59 @@
+
+
+
+#ifndef INCLUDED_MULTI_DRAW_RENDERER
+#define INCLUDED_MULTI_DRAW_RENDERER
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/platform/Window.h>
+
+#include <framework/BasicRenderer.h>
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
+#include <framework/mesh_lod.h>
+#include <framework/mesh_cache.h>
+#include <framework/geometry_pool.h>
+#include <framework/draw_batch.h>
+#include <framework/culling.h>
+
+#include "scene.h"
+
+
+// a grid of different meshes out of one geometry pool, all of them drawn with one multi-draw call
+class Renderer : public BasicRenderer
+{
+private:
+	int viewport_width;
+	int viewport_height;
+
+	ProgramCache programs;
+	GLuint program;
+	Buffer frame_uniforms;
+
+	std::vector<CachedMesh> meshes;
+	GeometryPool pool;
+	DrawBatch batch;
+
+	std::vector<GridObject> objects;
+	std::vector<LodSelector> lods;
+	BoundingSpheres bounds;
+	std::vector<std::uint32_t> visible;
+	float extent;
+
+	unsigned int frame;
+
+public:
+	Renderer(GL::platform::Window& window, std::size_t object_count);
+
+	// draw calls against the batch, printed to std::cout
+	void benchmark();
+
+	void resize(int width, int height);
+	void render();
+};
+
+#endif  // INCLUDED_MULTI_DRAW_RENDERER
@@ -0,0 +1,118 @@
+
+
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+#include <framework/gl_objects.h>
+#include <framework/draw_batch.h>
+#include <framework/mesh_buffers.h>
+#include <framework/timing.h>
+
+#include "scene.h"
+#include "benchmark.h"
+
+
+namespace
+{
+	const std::size_t object_counts[] = { 10, 100, 1000, 10000 };
+	const int frames = 20;
+}
+
+void benchmarkDrawCalls(GeometryPool& pool, const std::vector<CachedMesh>& meshes, ProgramCache& programs, std::ostream& out)
+{
+	// the way every mesh was drawn before the pool
+	std::vector<MeshBuffers> separate;
+	separate.reserve(meshes.size());
+	for (const CachedMesh& mesh : meshes)
+		separate.emplace_back(mesh);
+
+	// one triangle of every object and no rasterization, so what is measured is the cost of issuing
+	// the draws rather than the vertex work behind them, which a software rasterizer does right in the call
+	std::vector<PooledMesh> triangles;
+	for (std::size_t i = 0; i < pool.meshCount(); ++i)
+	{
+		PooledMesh triangle = pool.mesh(i);
+		triangle.lods.assign(1, MeshLod { triangle.lods[0].index_offset, 3, 0.0f });
+		triangles.push_back(triangle);
+	}
+
+	const ShaderProgram& object_program = programs.get(object_vertex_shader_src, fragment_shader_src);
+	GLint model_location = object_program.uniformLocation("Model");
+	GLint color_location = object_program.uniformLocation("Color");
+	bindUniformBlock(object_program, "Frame", frame_binding);
+
+	std::string batch_vertex_shader = batchVertexShader(pool);
+	const ShaderProgram& batch_program = programs.get(batch_vertex_shader.c_str(), fragment_shader_src);
+	bindUniformBlock(batch_program, "Frame", frame_binding);
+
+	DrawBatch batch;
+
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	out << "one triangle per object, " << pool.meshCount() << " meshes, average of " << frames << " frames, "
+	    << (pool.drawParameters() ? "gl_DrawIDARB" : "draw index attribute") << std::endl;
+	out << std::setw(8) << "objects" << std::setw(16) << "draw calls ms" << std::setw(12) << "VAO binds"
+	    << std::setw(12) << "batch ms" << std::setw(10) << "speedup" << std::setw(12) << "GL calls ms" << std::endl;
+
+	for (std::size_t count : object_counts)
+	{
+		std::vector<GridObject> objects = scatterObjects(pool, count, 1.0f, 1);
+
+		double separate_ms = 0.0, batch_ms = 0.0, submit_ms = 0.0;
+		std::size_t binds = 0;
+
+		// the first frame of each is a warm up
+		for (int f = 0; f <= frames; ++f)
+		{
+			float time = 0.01f * f;
+
+			auto start = std::chrono::steady_clock::now();
+			glUseProgram(object_program);
+			std::size_t bound = meshes.size();
+			for (const GridObject& object : objects)
+			{
+				if (object.mesh != bound)
+				{
+					glBindVertexArray(separate[object.mesh].vao);
+					bound = object.mesh;
+					binds += f > 0;
+				}
+				Instance instance = objectInstance(pool, object, time);
+				glUniformMatrix4fv(model_location, 1, GL_TRUE, math::float4x4(math::affine_float4x4(instance.transform))._m);
+				glUniform4fv(color_location, 1, &instance.color.x);
+				glDrawElements(GL_TRIANGLES, 3, separate[object.mesh].index_type, nullptr);
+			}
+			if (f > 0)
+				separate_ms += millisecondsSince(start);
+			glFinish();
+
+			start = std::chrono::steady_clock::now();
+			glUseProgram(batch_program);
+			batch.clear();
+			for (const GridObject& object : objects)
+				batch.add(triangles[object.mesh], 0, objectInstance(pool, object, time));
+			auto submit = std::chrono::steady_clock::now();
+			batch.upload(pool);
+			batch.submit(pool, draws_binding);
+			if (f > 0)
+			{
+				batch_ms += millisecondsSince(start);
+				submit_ms += millisecondsSince(submit);
+			}
+			glFinish();
+		}
+
+		out << std::fixed << std::setprecision(3)
+		    << std::setw(8) << count
+		    << std::setw(16) << separate_ms / frames
+		    << std::setw(12) << binds / frames
+		    << std::setw(12) << batch_ms / frames
+		    << std::setw(9) << std::setprecision(1) << separate_ms / batch_ms << "x"
+		    << std::setw(12) << std::setprecision(3) << submit_ms / frames << std::endl;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(0);
+}
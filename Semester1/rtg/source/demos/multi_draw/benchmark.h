@@ -0,0 +1,23 @@
+
+
+
+#ifndef INCLUDED_MULTI_DRAW_BENCHMARK
+#define INCLUDED_MULTI_DRAW_BENCHMARK
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include <framework/mesh_cache.h>
+#include <framework/shader.h>
+#include <framework/geometry_pool.h>
+
+
+// CPU time per frame to submit growing numbers of objects, once with a vertex array per mesh and a
+// draw call per object and once as a single multi-draw batch out of the pool; the meshes are the
+// ones the pool was filled with, in the same order; needs the frame uniforms bound, only the GL
+// context, not a window
+void benchmarkDrawCalls(GeometryPool& pool, const std::vector<CachedMesh>& meshes, ProgramCache& programs, std::ostream& out);
+
+#endif  // INCLUDED_MULTI_DRAW_BENCHMARK
@@ -0,0 +1,13 @@
+
+
+
+#include <framework/demo.h>
+
+#include "Renderer.h"
+
+
+// multi_draw [objects] | multi_draw --benchmark
+int main(int argc, char* argv[])
+{
+	return runDemo<Renderer>(argc, argv, "Multi-draw — one call for many meshes", 1000);
+}
@@ -0,0 +1,117 @@
+
+
+
+#include <random>
+
+#include "scene.h"
+
+
+const char* const mesh_files[] = {
+	"../assets/vader.obj",
+	"../assets/palmtree.obj",
+	"../assets/nukahedron.obj",
+	"../assets/cube.obj"
+};
+
+std::vector<GridObject> scatterObjects(const GeometryPool& pool, std::size_t count, float spacing, unsigned int seed)
+{
+	std::vector<float> sizes;
+	for (std::size_t i = 0; i < pool.meshCount(); ++i)
+		sizes.push_back(length(pool.mesh(i).bbox_max - pool.mesh(i).bbox_min));
+
+	std::mt19937 random(seed);
+	return scatterGrid(sizes, count, spacing, 0.3f, random);
+}
+
+Instance objectInstance(const GeometryPool& pool, const GridObject& object, float time)
+{
+	const PooledMesh& mesh = pool.mesh(object.mesh);
+	return Instance { gridTransform(object, mesh.bbox_min, mesh.bbox_max, time), object.color };
+}
+
+std::string batchVertexShader(const GeometryPool& pool)
+{
+	return std::string("#version 430\n") + pool.drawIndexGLSL() + R"(
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+struct Draw
+{
+	vec4 transform[3];
+	vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Draws
+{
+	Draw draws[];
+};
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+out vec3 worldNormal;
+out vec4 color;
+
+void main()
+{
+	Draw draw = draws[DRAW_INDEX];
+	mat4 model = transpose(mat4(draw.transform[0], draw.transform[1], draw.transform[2], vec4(0.0, 0.0, 0.0, 1.0)));
+	gl_Position = Projection * View * model * vec4(position, 1.0);
+	worldNormal = mat3(model) * normal;
+	color = draw.color;
+}
+)";
+}
+
+const char* object_vertex_shader_src = R"(
+#version 330
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+
+uniform mat4 Model;
+uniform vec4 Color;
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+out vec3 worldNormal;
+out vec4 color;
+
+void main()
+{
+	gl_Position = Projection * View * Model * vec4(position, 1.0);
+	worldNormal = mat3(Model) * normal;
+	color = Color;
+}
+)";
+
+const char* fragment_shader_src = R"(
+#version 330
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+in vec3 worldNormal;
+in vec4 color;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+	float lambert = max(dot(normalize(worldNormal), LightDirection.xyz), 0.0);
+	fragColor = vec4(color.rgb * (0.35 + 0.65 * lambert), color.a);
+}
+)";
@@ -0,0 +1,42 @@
+
+
+
+#ifndef INCLUDED_MULTI_DRAW_SCENE
+#define INCLUDED_MULTI_DRAW_SCENE
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include <framework/math/vector.h>
+#include <framework/math/matrix.h>
+#include <framework/frame_uniforms.h>
+#include <framework/instancing.h>
+#include <framework/object_grid.h>
+#include <framework/geometry_pool.h>
+
+
+const GLuint frame_binding = 0;
+const GLuint draws_binding = 0;
+
+extern const char* const mesh_files[];
+const std::size_t mesh_file_count = 4;
+
+// count objects on a grid, with their mesh picked from the pool
+std::vector<GridObject> scatterObjects(const GeometryPool& pool, std::size_t count, float spacing, unsigned int seed);
+
+// where the object is after time seconds, with its mesh centered on its position
+Instance objectInstance(const GeometryPool& pool, const GridObject& object, float time);
+
+// the batch shaders read the per-draw data at DRAW_INDEX, which depends on what the pool supports
+std::string batchVertexShader(const GeometryPool& pool);
+
+// the same without the batch, per-object transform and color in uniforms
+extern const char* object_vertex_shader_src;
+extern const char* fragment_shader_src;
+
+#endif  // INCLUDED_MULTI_DRAW_SCENE
@@ -0,0 +1,100 @@
+
+
+
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <framework/obj.h>
+#include <framework/parallel.h>
+
+
+namespace
+{
+	const char* default_assets[] = {
+		"assets/cube.obj",
+		"assets/nukahedron.obj",
+		"assets/vader.obj",
+		"assets/palmtree.obj",
+		"assets/desert.obj"
+	};
+
+	bool identical(const OBJ::Mesh& a, const OBJ::Mesh& b)
+	{
+		return a.position_x == b.position_x && a.position_y == b.position_y && a.position_z == b.position_z &&
+		       a.normal_x == b.normal_x && a.normal_y == b.normal_y && a.normal_z == b.normal_z &&
+		       a.texcoord_u == b.texcoord_u && a.texcoord_v == b.texcoord_v &&
+		       a.position_indices == b.position_indices && a.texcoord_indices == b.texcoord_indices && a.normal_indices == b.normal_indices;
+	}
+
+	void benchmark(const char* filename, unsigned int max_threads, int repetitions)
+	{
+		OBJ::LoadStats serial_stats;
+		OBJ::Mesh reference = OBJ::loadMesh(filename, &serial_stats, 1);
+
+		std::cout << filename << ": " << serial_stats.bytes << " bytes, " << reference.triangleCount() << " triangles" << std::endl;
+
+		double serial_seconds = 0.0;
+
+		// powers of two up to the hardware thread count, plus the thread count itself
+		std::vector<unsigned int> thread_counts;
+		for (unsigned int threads = 1; threads < max_threads; threads *= 2)
+			thread_counts.push_back(threads);
+		thread_counts.push_back(max_threads);
+
+		for (unsigned int threads : thread_counts)
+		{
+			OBJ::LoadStats best = { 0, 0.0, 0 };
+			bool match = true;
+
+			for (int i = 0; i < repetitions; ++i)
+			{
+				OBJ::LoadStats stats;
+				OBJ::Mesh mesh = OBJ::loadMesh(filename, &stats, threads);
+				match = match && identical(mesh, reference);
+				if (i == 0 || stats.seconds < best.seconds)
+					best = stats;
+			}
+
+			if (threads == 1)
+				serial_seconds = best.seconds;
+
+			std::cout << "  " << std::setw(3) << threads << " threads (" << std::setw(3) << best.threads << " used): "
+			          << std::fixed << std::setprecision(3) << std::setw(9) << best.seconds * 1000.0 << " ms "
+			          << std::setprecision(1) << std::setw(8) << best.throughput() << " MB/s  speedup "
+			          << std::setprecision(2) << serial_seconds / best.seconds << "x"
+			          << (match ? "" : "  MISMATCH") << std::endl;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		unsigned int max_threads = parallel::hardwareThreads();
+		const int repetitions = 10;
+
+		std::cout << "OBJ load benchmark, best of " << repetitions << " runs, up to " << max_threads << " threads" << std::endl;
+
+		if (argc > 1)
+			for (int i = 1; i < argc; ++i)
+				benchmark(argv[i], max_threads, repetitions);
+		else
+			for (const char* filename : default_assets)
+				benchmark(filename, max_threads, repetitions);
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (...)
+	{
+		std::cout << "unknown exception" << std::endl;
+		return -128;
+	}
+
+	return 0;
+}
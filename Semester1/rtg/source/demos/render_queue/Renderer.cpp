@@ -0,0 +1,124 @@
+
+
+
+#include <cmath>
+#include <iostream>
+
+#include <framework/math/camera.h>
+#include <framework/instrumentation/profiler.h>
+
+#include "Renderer.h"
+#include "benchmark.h"
+
+
+namespace
+{
+	const float fov = 3.14159265f / 3.0f;
+	const float near_plane = 0.1f;
+	const float far_plane = 500.0f;
+	const float spacing = 1.0f;
+	const unsigned int report_frames = 300;
+}
+
+Renderer::Renderer(GL::platform::Window& window, std::size_t object_count)
+	: BasicRenderer(window, 3, 3),
+	  viewport_width(800),
+	  viewport_height(600),
+	  programs("shader_cache"),
+	  frame_uniforms(createBuffer(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW)),
+	  frame(0)
+{
+	glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+	glEnable(GL_DEPTH_TEST);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	for (std::size_t i = 0; i < mesh_file_count; ++i)
+		meshes.emplace_back(loadCachedMesh(mesh_files[i]));
+	for (std::size_t i = 0; i < texture_file_count; ++i)
+		textures.push_back(loadTexture(texture_files[i]));
+
+	for (std::size_t i = 0; i < program_count; ++i)
+	{
+		const ShaderProgram& program = programs.get(vertex_shader_src, fragment_shaders_src[i]);
+		bindUniformBlock(program, "Frame", frame_binding);
+		program_names.push_back(program);
+		model_locations.push_back(program.uniformLocation("Model"));
+		color_locations.push_back(program.uniformLocation("Color"));
+	}
+	glBindBufferBase(GL_UNIFORM_BUFFER, frame_binding, frame_uniforms);
+
+	objects = scatterObjects(meshes, textures.size(), program_names.size(), object_count, spacing, 1);
+	extent = spacing * std::sqrt(static_cast<float>(objects.size()));
+
+	std::cout << objects.size() << " objects, " << meshes.size() << " meshes, " << textures.size() << " textures, "
+	          << program_names.size() << " programs" << std::endl;
+
+	window.attach(this);
+}
+
+void Renderer::benchmark()
+{
+	setFrameUniforms(frame_uniforms, math::look_at(math::float3(0.0f, 0.6f * extent, 0.8f * extent), math::float3(0.0f, 0.0f, 0.0f), math::float3(0.0f, 1.0f, 0.0f)),
+	                                 math::perspective(fov, 4.0f / 3.0f, near_plane, far_plane));
+	benchmarkStateChanges(meshes, textures, program_names, std::cout);
+}
+
+void Renderer::resize(int width, int height)
+{
+	viewport_width = width;
+	viewport_height = height;
+}
+
+void Renderer::render()
+{
+	PROFILE_ZONE("render");
+
+	glViewport(0, 0, viewport_width, viewport_height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// circle the grid slowly
+	float angle = 0.002f * frame;
+	math::float3 camera(0.8f * extent * std::sin(angle), 0.6f * extent, 0.8f * extent * std::cos(angle));
+	math::float3 forward = normalize(-camera);
+
+	setFrameUniforms(frame_uniforms, math::look_at(camera, math::float3(0.0f, 0.0f, 0.0f), math::float3(0.0f, 1.0f, 0.0f)),
+	                                 math::perspective(fov, float(viewport_width) / float(viewport_height), near_plane, far_plane));
+
+	queue.clear();
+	for (std::uint32_t i = 0; i < objects.size(); ++i)
+	{
+		const SceneObject& object = objects[i];
+		queue.add(object.color.w < 1.0f ? RenderQueue::TRANSPARENT_PASS : RenderQueue::OPAQUE_PASS, dot(object.position - camera, forward),
+		          objectDraw(meshes, textures, program_names, object, i));
+	}
+	queue.sort();
+
+	float time = frame / 60.0f;
+	queue.submit([](unsigned int pass)
+	{
+		// the transparent objects blend over what is behind them, without hiding each other
+		bool transparent = pass == RenderQueue::TRANSPARENT_PASS;
+		if (transparent)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+		glDepthMask(transparent ? GL_FALSE : GL_TRUE);
+	},
+	[this, time](const DrawItem& item)
+	{
+		const SceneObject& object = objects[item.object];
+		glUniformMatrix4fv(model_locations[object.program], 1, GL_TRUE, objectMatrix(meshes[object.mesh], object, time)._m);
+		glUniform4fv(color_locations[object.program], 1, &object.color.x);
+	});
+	glDepthMask(GL_TRUE);
+
+	if (frame % report_frames == 0)
+	{
+		const StateChanges& changes = queue.stateChanges();
+		std::cout << changes.draws << " draws, " << changes.programs << " program, " << changes.textures << " texture and "
+		          << changes.vertex_arrays << " vertex array binds; " << 3 * changes.draws << " without the queue" << std::endl;
+	}
+
+	swapBuffers();
+	++frame;
+}
@@ -0,0 +1,55 @@
+
+
+
+#ifndef INCLUDED_RENDER_QUEUE_RENDERER
+#define INCLUDED_RENDER_QUEUE_RENDERER
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/platform/Window.h>
+
+#include <framework/BasicRenderer.h>
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
+#include <framework/render_queue.h>
+
+#include "scene.h"
+
+
+// a grid of objects with their own meshes, textures and programs, some of them transparent, all
+// going through the render queue
+class Renderer : public BasicRenderer
+{
+private:
+	int viewport_width;
+	int viewport_height;
+
+	ProgramCache programs;
+	std::vector<GLuint> program_names;
+	std::vector<GLint> model_locations;
+	std::vector<GLint> color_locations;
+	Buffer frame_uniforms;
+
+	std::vector<MeshBuffers> meshes;
+	std::vector<Texture> textures;
+	std::vector<SceneObject> objects;
+	float extent;
+
+	RenderQueue queue;
+
+	unsigned int frame;
+
+public:
+	Renderer(GL::platform::Window& window, std::size_t object_count);
+
+	// binds per frame with and without the queue, printed to std::cout
+	void benchmark();
+
+	void resize(int width, int height);
+	void render();
+};
+
+#endif  // INCLUDED_RENDER_QUEUE_RENDERER
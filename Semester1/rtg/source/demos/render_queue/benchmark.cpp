@@ -0,0 +1,146 @@
+
+
+
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+#include <framework/render_queue.h>
+#include <framework/gl_state.h>
+#include <framework/timing.h>
+
+#include "benchmark.h"
+
+
+namespace
+{
+	const std::size_t object_counts[] = { 100, 1000, 10000 };
+	const int frames = 20;
+}
+
+void benchmarkStateChanges(const std::vector<MeshBuffers>& meshes, const std::vector<Texture>& textures, const std::vector<GLuint>& programs,
+                           std::ostream& out)
+{
+	std::vector<GLint> model_locations, color_locations;
+	for (GLuint program : programs)
+	{
+		model_locations.push_back(glGetUniformLocation(program, "Model"));
+		color_locations.push_back(glGetUniformLocation(program, "Color"));
+	}
+
+	RenderQueue queue;
+	GLStateCache state;
+
+	// the binds are what counts here: every object is cut down to its first triangle and nothing reaches
+	// the rasterizer, which leaves little but the state changes and the calls themselves to time
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	out << "one triangle per object, " << meshes.size() << " meshes, " << textures.size() << " textures, " << programs.size()
+	    << " programs, average of " << frames << " frames" << std::endl;
+	out << std::setw(8) << "objects" << std::setw(16) << "binds as is" << std::setw(10) << "cached" << std::setw(10) << "in order" << std::setw(10) << "sorted"
+	    << std::setw(12) << "as is ms" << std::setw(12) << "cached ms" << std::setw(12) << "queue ms" << std::setw(10) << "sort ms" << std::endl;
+
+	for (std::size_t count : object_counts)
+	{
+		float spacing = 1.0f;
+		std::vector<SceneObject> objects = scatterObjects(meshes, textures.size(), programs.size(), count, spacing, 1);
+
+		float extent = spacing * std::sqrt(static_cast<float>(count));
+		math::float3 camera(0.0f, 0.6f * extent, 0.8f * extent);
+		math::float3 forward = normalize(-camera);
+
+		auto setObject = [&](const DrawItem& item)
+		{
+			const SceneObject& object = objects[item.object];
+			glUniformMatrix4fv(model_locations[object.program], 1, GL_TRUE, objectMatrix(meshes[object.mesh], object, 0.0f)._m);
+			glUniform4fv(color_locations[object.program], 1, &object.color.x);
+		};
+
+		double as_is_ms = 0.0, cached_ms = 0.0, queue_ms = 0.0, sort_ms = 0.0;
+		std::size_t cached = 0, in_order = 0, sorted = 0;
+
+		// the first frame of each is a warm up
+		for (int f = 0; f <= frames; ++f)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (std::uint32_t i = 0; i < objects.size(); ++i)
+			{
+				DrawItem item = objectDraw(meshes, textures, programs, objects[i], i);
+				glUseProgram(item.program);
+				glBindTexture(GL_TEXTURE_2D, item.texture);
+				glBindVertexArray(item.vertex_array);
+				setObject(item);
+				glDrawElements(GL_TRIANGLES, 3, item.index_type, nullptr);
+			}
+			if (f > 0)
+				as_is_ms += millisecondsSince(start);
+			glFinish();
+
+			// the same binds through the state cache, which drops those that change nothing
+			start = std::chrono::steady_clock::now();
+			state.invalidate();
+			state.beginFrame();
+			state.activeTexture(GL_TEXTURE0);
+			for (std::uint32_t i = 0; i < objects.size(); ++i)
+			{
+				DrawItem item = objectDraw(meshes, textures, programs, objects[i], i);
+				state.useProgram(item.program);
+				state.bindTexture(GL_TEXTURE_2D, item.texture);
+				state.bindVertexArray(item.vertex_array);
+				setObject(item);
+				glDrawElements(GL_TRIANGLES, 3, item.index_type, nullptr);
+			}
+			if (f > 0)
+			{
+				cached_ms += millisecondsSince(start);
+				cached += state.frameCounters().issued;
+			}
+			glFinish();
+
+			auto fill = [&]()
+			{
+				queue.clear();
+				for (std::uint32_t i = 0; i < objects.size(); ++i)
+				{
+					DrawItem item = objectDraw(meshes, textures, programs, objects[i], i);
+					item.index_count = 3;
+					queue.add(objects[i].color.w < 1.0f ? RenderQueue::TRANSPARENT_PASS : RenderQueue::OPAQUE_PASS, dot(objects[i].position - camera, forward), item);
+				}
+			};
+
+			fill();
+			queue.submit(nullptr, setObject);
+			in_order += f > 0 ? queue.stateChanges().total() : 0;
+			glFinish();
+
+			start = std::chrono::steady_clock::now();
+			fill();
+			auto sort_start = std::chrono::steady_clock::now();
+			queue.sort();
+			double sort_time = millisecondsSince(sort_start);
+			queue.submit(nullptr, setObject);
+			if (f > 0)
+			{
+				queue_ms += millisecondsSince(start);
+				sort_ms += sort_time;
+				sorted += queue.stateChanges().total();
+			}
+			glFinish();
+		}
+
+		out << std::fixed << std::setprecision(3)
+		    << std::setw(8) << count
+		    << std::setw(16) << 3 * count
+		    << std::setw(10) << cached / frames
+		    << std::setw(10) << in_order / frames
+		    << std::setw(10) << sorted / frames
+		    << std::setw(12) << as_is_ms / frames
+		    << std::setw(12) << cached_ms / frames
+		    << std::setw(12) << queue_ms / frames
+		    << std::setw(10) << sort_ms / frames << std::endl;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(0);
+}
@@ -0,0 +1,24 @@
+
+
+
+#ifndef INCLUDED_RENDER_QUEUE_BENCHMARK
+#define INCLUDED_RENDER_QUEUE_BENCHMARK
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include <framework/gl_objects.h>
+
+#include "scene.h"
+
+
+// binds per frame and CPU time to submit growing numbers of objects: as the tasks do it, binding
+// program, texture and vertex array for every draw, the same through the GL state cache, then through
+// the render queue in the order the objects were added and sorted by key; one of the programs per look
+// in the order of fragment_shaders_src, the frame uniforms bound; needs only the GL context, not a window
+void benchmarkStateChanges(const std::vector<MeshBuffers>& meshes, const std::vector<Texture>& textures, const std::vector<GLuint>& programs,
+                           std::ostream& out);
+
+#endif  // INCLUDED_RENDER_QUEUE_BENCHMARK
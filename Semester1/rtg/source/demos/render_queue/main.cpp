@@ -0,0 +1,13 @@
+
+
+
+#include <framework/demo.h>
+
+#include "Renderer.h"
+
+
+// render_queue [objects] | render_queue --benchmark
+int main(int argc, char* argv[])
+{
+	return runDemo<Renderer>(argc, argv, "Render queue — draws sorted by state", 1000);
+}
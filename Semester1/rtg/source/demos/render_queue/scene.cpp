@@ -0,0 +1,144 @@
+
+
+
+#include <random>
+
+#include <framework/png.h>
+
+#include "scene.h"
+
+
+const char* const mesh_files[] = {
+	"../assets/vader.obj",
+	"../assets/palmtree.obj",
+	"../assets/nukahedron.obj",
+	"../assets/cube.obj"
+};
+
+const char* const texture_files[] = {
+	"../assets/vader.png",
+	"../assets/nukahedron_diffuse.png",
+	"../assets/Red-brick-wall.png",
+	"../assets/sand.png",
+	"../assets/smile.png"
+};
+
+Texture loadTexture(const char* png_filename)
+{
+	image<std::uint32_t> img = PNG::loadImage2D(png_filename);
+
+	Texture texture = createTexture();
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(width(img)), static_cast<GLsizei>(height(img)), 0, GL_RGBA, GL_UNSIGNED_BYTE, data(img));
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	return texture;
+}
+
+std::vector<SceneObject> scatterObjects(const std::vector<MeshBuffers>& meshes, std::size_t textures, std::size_t programs,
+                                        std::size_t count, float spacing, unsigned int seed)
+{
+	std::vector<float> sizes;
+	for (const MeshBuffers& mesh : meshes)
+		sizes.push_back(length(mesh.bbox_max - mesh.bbox_min));
+
+	std::mt19937 random(seed);
+	std::vector<GridObject> grid = scatterGrid(sizes, count, spacing, 0.6f, random);
+
+	std::uniform_int_distribution<std::size_t> texture(0, textures - 1);
+	std::uniform_int_distribution<std::size_t> program(0, programs - 1);
+
+	std::vector<SceneObject> objects(grid.size());
+	for (std::size_t i = 0; i < grid.size(); ++i)
+	{
+		static_cast<GridObject&>(objects[i]) = grid[i];
+		objects[i].texture = texture(random);
+		objects[i].program = program(random);
+		if (i % 8 == 7)
+			objects[i].color.w = 0.5f;
+	}
+
+	return objects;
+}
+
+math::float4x4 objectMatrix(const MeshBuffers& mesh, const SceneObject& object, float time)
+{
+	return math::affine_float4x4(gridTransform(object, mesh.bbox_min, mesh.bbox_max, time));
+}
+
+DrawItem objectDraw(const std::vector<MeshBuffers>& meshes, const std::vector<Texture>& textures, const std::vector<GLuint>& programs,
+                    const SceneObject& object, std::uint32_t index)
+{
+	const MeshBuffers& mesh = meshes[object.mesh];
+	return DrawItem { programs[object.program], mesh.vao, textures[object.texture], mesh.index_type, mesh.index_count, 0, 0, index };
+}
+
+const char* vertex_shader_src = R"(
+#version 330
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoord;
+
+uniform mat4 Model;
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+out vec3 worldNormal;
+out vec2 uv;
+
+void main()
+{
+	gl_Position = Projection * View * Model * vec4(position, 1.0);
+	worldNormal = mat3(Model) * normal;
+	uv = texcoord;
+}
+)";
+
+const char* const fragment_shaders_src[] = {
+R"(
+#version 330
+
+layout(std140) uniform Frame
+{
+	mat4 View;
+	mat4 Projection;
+	vec4 LightDirection;
+};
+
+uniform sampler2D Texture;
+uniform vec4 Color;
+
+in vec3 worldNormal;
+in vec2 uv;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+	float lambert = max(dot(normalize(worldNormal), LightDirection.xyz), 0.0);
+	fragColor = vec4(texture(Texture, uv).rgb * Color.rgb * (0.35 + 0.65 * lambert), Color.a);
+}
+)",
+R"(
+#version 330
+
+uniform sampler2D Texture;
+uniform vec4 Color;
+
+in vec3 worldNormal;
+in vec2 uv;
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+	fragColor = vec4(texture(Texture, uv).rgb * Color.rgb, Color.a);
+}
+)"
+};
@@ -0,0 +1,60 @@
+
+
+
+#ifndef INCLUDED_RENDER_QUEUE_SCENE
+#define INCLUDED_RENDER_QUEUE_SCENE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include <framework/math/vector.h>
+#include <framework/math/matrix.h>
+#include <framework/gl_objects.h>
+#include <framework/mesh_buffers.h>
+#include <framework/object_grid.h>
+#include <framework/render_queue.h>
+#include <framework/frame_uniforms.h>
+
+
+const GLuint frame_binding = 0;
+
+extern const char* const mesh_files[];
+const std::size_t mesh_file_count = 4;
+
+extern const char* const texture_files[];
+const std::size_t texture_file_count = 5;
+
+// a PNG with its mipmaps, left bound to GL_TEXTURE_2D
+Texture loadTexture(const char* png_filename);
+
+// an object on the grid with the texture and program it is drawn with; the ones with an alpha below
+// one are drawn in the transparent pass
+struct SceneObject : GridObject
+{
+	std::size_t texture;
+	std::size_t program;
+};
+
+// count objects on a grid with mesh, texture and program picked at random, so that neighbours rarely
+// share their state; every eighth one is transparent
+std::vector<SceneObject> scatterObjects(const std::vector<MeshBuffers>& meshes, std::size_t textures, std::size_t programs,
+                                        std::size_t count, float spacing, unsigned int seed);
+
+// the model matrix of the object after time seconds
+math::float4x4 objectMatrix(const MeshBuffers& mesh, const SceneObject& object, float time);
+
+// the draw of the object, with index as its object
+DrawItem objectDraw(const std::vector<MeshBuffers>& meshes, const std::vector<Texture>& textures, const std::vector<GLuint>& programs,
+                    const SceneObject& object, std::uint32_t index);
+
+// a lit and an unlit look, the same vertex shader for both
+extern const char* vertex_shader_src;
+extern const char* const fragment_shaders_src[];
+const std::size_t program_count = 2;
+
+#endif  // INCLUDED_RENDER_QUEUE_SCENE
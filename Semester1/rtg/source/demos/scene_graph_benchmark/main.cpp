@@ -0,0 +1,124 @@
+
+
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <framework/scene_graph.h>
+#include <framework/timing.h>
+
+
+namespace
+{
+	const std::size_t node_count = 100000;
+	const std::size_t children_per_node = 8;
+	const double changing_fractions[] = { 0.0, 0.001, 0.01, 0.1, 1.0 };
+	const int frames = 50;
+
+	Transform randomTransform(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+		std::uniform_real_distribution<float> scale(0.9f, 1.1f);
+		return Transform(math::float3(offset(random), offset(random), offset(random)),
+		                 math::float3(angle(random), angle(random), angle(random)),
+		                 math::float3(scale(random), scale(random), scale(random)));
+	}
+
+	// what the tasks did: every local matrix rebuilt and every world matrix recomputed each frame
+	void updateEverything(const SceneGraph& scene, std::vector<math::float4x4>& worlds)
+	{
+		for (SceneGraph::Node i = 0; i < scene.size(); ++i)
+		{
+			math::float4x4 local = localMatrix(scene.local(i));
+			SceneGraph::Node parent = scene.parent(i);
+			worlds[i] = parent == SceneGraph::none ? local : multiplyAffine(worlds[parent], local);
+		}
+	}
+
+	float maxDifference(const SceneGraph& scene, const std::vector<math::float4x4>& worlds)
+	{
+		float difference = 0.0f;
+		for (SceneGraph::Node i = 0; i < scene.size(); ++i)
+			for (int k = 0; k < 12; ++k)
+				difference = std::max(difference, std::abs(scene.world(i)._m[k] - worlds[i]._m[k]));
+		return difference;
+	}
+}
+
+// update cost of a scene graph of 100000 nodes with a part of them changing every frame, against
+// recomputing all of them
+int main()
+{
+	try
+	{
+		std::mt19937 random(1);
+
+		// an 8-ary tree, so most nodes are leaves and a change near the root moves many
+		SceneGraph scene;
+		scene.reserve(node_count);
+		for (std::size_t i = 0; i < node_count; ++i)
+			scene.add(randomTransform(random), i == 0 ? SceneGraph::none : static_cast<SceneGraph::Node>((i - 1) / children_per_node));
+		scene.update();
+
+		std::vector<math::float4x4> worlds(node_count);
+
+		std::cout << node_count << " nodes, " << children_per_node << " children each, average of " << frames << " frames" << std::endl;
+		std::cout << std::setw(10) << "changing" << std::setw(14) << "recomputed" << std::setw(14) << "dirty ms"
+		          << std::setw(16) << "everything ms" << std::setw(10) << "speedup" << std::endl;
+
+		for (double fraction : changing_fractions)
+		{
+			std::size_t changing = static_cast<std::size_t>(fraction * node_count);
+			std::uniform_int_distribution<SceneGraph::Node> node(0, static_cast<SceneGraph::Node>(node_count - 1));
+
+			double dirty_ms = 0.0, everything_ms = 0.0;
+			std::size_t recomputed = 0;
+
+			for (int f = 0; f < frames; ++f)
+			{
+				for (std::size_t i = 0; i < changing; ++i)
+					scene.setLocal(node(random), randomTransform(random));
+
+				auto start = std::chrono::steady_clock::now();
+				scene.update();
+				dirty_ms += millisecondsSince(start);
+				recomputed += scene.recomputedNodes();
+
+				start = std::chrono::steady_clock::now();
+				updateEverything(scene, worlds);
+				everything_ms += millisecondsSince(start);
+			}
+
+			float difference = maxDifference(scene, worlds);
+			if (difference > 1e-3f)
+				throw std::runtime_error("cached world matrices differ from recomputed ones");
+
+			std::cout << std::fixed << std::setprecision(1)
+			          << std::setw(9) << 100.0 * fraction << "%"
+			          << std::setw(14) << recomputed / frames
+			          << std::setprecision(3)
+			          << std::setw(14) << dirty_ms / frames
+			          << std::setw(16) << everything_ms / frames
+			          << std::setw(9) << std::setprecision(1) << everything_ms / dirty_ms << "x" << std::endl;
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (...)
+	{
+		std::cout << "unknown exception" << std::endl;
+		return -128;
+	}
+
+	return 0;
+}
@@ -1,16 +1,35 @@
 
 
 
+#include "gl_diagnostics.h"
 #include "BasicRenderer.h"
 
 
+namespace
+{
+	// a debug context may be slower, release builds go without
+#ifdef _DEBUG
+	const bool debug_context = true;
+#else
+	const bool debug_context = false;
+#endif
+}
+
 BasicRenderer::BasicRenderer(GL::platform::Window& window, int version_major, int version_minor)
-	: context(window.createContext(version_major, version_minor, true)),
+	: context(window.createContext(version_major, version_minor, debug_context)),
 	  ctx(context, window)
 {
+#ifdef _DEBUG
+	installGLDebugOutput();
+#endif
 }
 
 void BasicRenderer::swapBuffers()
 {
 	ctx.swapBuffers();
+
+	// what no GL_SAFE_CALL caught shows up at the end of its frame
+#ifdef _DEBUG
+	checkGLError();
+#endif
 }
@@ -0,0 +1,153 @@
+
+
+
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <exception>
+
+#include "png.h"
+#include "asset_loader.h"
+
+
+AssetLoader::AssetLoader(unsigned int threads)
+	: working(0),
+	  stopping(false)
+{
+	for (unsigned int i = 0; i < (threads ? threads : 1); ++i)
+		workers.emplace_back(&AssetLoader::work, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		// nobody is going to upload them any more
+		jobs.clear();
+	}
+	job_available.notify_all();
+
+	for (auto&& worker : workers)
+		worker.join();
+}
+
+void AssetLoader::work()
+{
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (stopping)
+				return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			++working;
+		}
+
+		Upload upload;
+		try
+		{
+			upload = job();
+		}
+		catch (...)
+		{
+			// reported on the render thread, where someone can handle it
+			std::exception_ptr e = std::current_exception();
+			upload = [e]() -> bool { std::rethrow_exception(e); };
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		uploads.push_back(std::move(upload));
+		--working;
+	}
+}
+
+void AssetLoader::enqueue(Job job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	job_available.notify_one();
+}
+
+void AssetLoader::loadMesh(const std::string& obj_filename, bool flip_v, std::function<Upload(std::shared_ptr<const CachedMesh>)> prepare)
+{
+	enqueue([obj_filename, flip_v, prepare]() -> Upload
+	{
+		return prepare(std::make_shared<CachedMesh>(loadCachedMesh(obj_filename.c_str(), flip_v)));
+	});
+}
+
+void AssetLoader::loadImage(const std::string& png_filename, std::function<Upload(std::shared_ptr<const image<std::uint32_t>>)> prepare)
+{
+	enqueue([png_filename, prepare]() -> Upload
+	{
+		return prepare(std::make_shared<image<std::uint32_t>>(PNG::loadImage2D(png_filename.c_str())));
+	});
+}
+
+AssetLoader::Upload AssetLoader::chunked(std::size_t size, std::size_t chunk_size, std::function<void(std::size_t, std::size_t)> upload)
+{
+	std::size_t offset = 0;
+	return [size, chunk_size, upload, offset]() mutable
+	{
+		std::size_t n = std::min(chunk_size ? chunk_size : size, size - offset);
+		if (n)
+			upload(offset, n);
+		offset += n;
+		return offset == size;
+	};
+}
+
+AssetLoader::Upload AssetLoader::sequence(std::vector<Upload> steps)
+{
+	std::size_t next = 0;
+	return [steps, next]() mutable
+	{
+		// a finished step hands over to the next one on the following call, the loader checks the budget in between
+		if (next < steps.size() && steps[next]())
+			++next;
+		return next == steps.size();
+	};
+}
+
+std::size_t AssetLoader::upload(double budget_ms)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(budget_ms));
+
+	std::size_t finished = 0;
+
+	for (bool first = true; first || std::chrono::steady_clock::now() < deadline; first = false)
+	{
+		Upload step;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (uploads.empty())
+				break;
+			step = std::move(uploads.front());
+			uploads.pop_front();
+		}
+
+		if (step())
+			++finished;
+		else
+		{
+			// not done yet, it goes first again next time
+			std::lock_guard<std::mutex> lock(mutex);
+			uploads.push_front(std::move(step));
+		}
+	}
+
+	return finished;
+}
+
+std::size_t AssetLoader::pending() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return jobs.size() + working + uploads.size();
+}
@@ -0,0 +1,76 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_ASSET_LOADER
+#define INCLUDED_FRAMEWORK_ASSET_LOADER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include "image.h"
+#include "mesh_cache.h"
+
+
+// parses and decodes assets on worker threads; what the GL needs from them is queued as upload steps
+// that the render thread runs within a time budget per frame. the budget is only checked between
+// steps, a large payload has to come in steps of bounded size, see chunked()
+class AssetLoader
+{
+public:
+	// runs on the render thread; returns false to be called again with the next budget
+	typedef std::function<bool()> Upload;
+
+	// runs on a worker thread and returns the upload step for its result
+	typedef std::function<Upload()> Job;
+
+private:
+	std::vector<std::thread> workers;
+
+	mutable std::mutex mutex;
+	std::condition_variable job_available;
+	std::deque<Job> jobs;
+	std::deque<Upload> uploads;
+	std::size_t working;
+	bool stopping;
+
+	void work();
+
+public:
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator =(const AssetLoader&) = delete;
+
+	AssetLoader(unsigned int threads = 1);
+	~AssetLoader();
+
+	void enqueue(Job job);
+
+	// prepare runs on the worker with the loaded asset, does whatever is left to make it ready for the GL
+	// and returns the steps that upload it; they have to hold on to what they upload
+	void loadMesh(const std::string& obj_filename, bool flip_v, std::function<Upload(std::shared_ptr<const CachedMesh>)> prepare);
+	void loadImage(const std::string& png_filename, std::function<Upload(std::shared_ptr<const image<std::uint32_t>>)> prepare);
+
+	// a step for every chunk_size of [0, size), calling upload(offset, size) for each in order
+	static Upload chunked(std::size_t size, std::size_t chunk_size, std::function<void(std::size_t, std::size_t)> upload);
+
+	// the steps one after the other
+	static Upload sequence(std::vector<Upload> steps);
+
+	// runs queued upload steps until budget_ms is spent, but at least one; a failed job rethrows its
+	// exception here; returns the number of finished steps
+	std::size_t upload(double budget_ms);
+
+	// jobs that are queued, being worked on, or waiting for their upload
+	std::size_t pending() const;
+};
+
+#endif  // INCLUDED_FRAMEWORK_ASSET_LOADER
@@ -0,0 +1,293 @@
+
+
+
+#include <algorithm>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CULLING_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// AVX code is compiled per function, the rest of the framework stays at the baseline instruction set
+#if defined(CULLING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CULLING_TARGET_AVX __attribute__((target("avx")))
+#else
+#define CULLING_TARGET_AVX
+#endif
+
+#include "parallel.h"
+#include "culling.h"
+
+
+void BoundingSpheres::reserve(std::size_t count)
+{
+	x.reserve(count);
+	y.reserve(count);
+	z.reserve(count);
+	radius.reserve(count);
+}
+
+void BoundingSpheres::clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	radius.clear();
+}
+
+void BoundingBoxes::reserve(std::size_t count)
+{
+	for (std::vector<float>* v : { &min_x, &min_y, &min_z, &max_x, &max_y, &max_z })
+		v->reserve(count);
+}
+
+void BoundingBoxes::clear()
+{
+	for (std::vector<float>* v : { &min_x, &min_y, &min_z, &max_x, &max_y, &max_z })
+		v->clear();
+}
+
+
+namespace
+{
+	// the arrays of one box corner, the one furthest along each plane normal
+	struct BoxCorners
+	{
+		const float* x[6];
+		const float* y[6];
+		const float* z[6];
+
+		BoxCorners(const math::frustum& f, const BoundingBoxes& boxes)
+		{
+			for (int p = 0; p < 6; ++p)
+			{
+				x[p] = f.planes[p].x > 0.0f ? boxes.max_x.data() : boxes.min_x.data();
+				y[p] = f.planes[p].y > 0.0f ? boxes.max_y.data() : boxes.min_y.data();
+				z[p] = f.planes[p].z > 0.0f ? boxes.max_z.data() : boxes.min_z.data();
+			}
+		}
+	};
+
+	std::size_t cullSpheresScalar(const math::frustum& f, const BoundingSpheres& s, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		std::size_t n = 0;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			visible[n] = static_cast<std::uint32_t>(i);
+			n += math::intersects(f, math::float3(s.x[i], s.y[i], s.z[i]), s.radius[i]);
+		}
+		return n;
+	}
+
+	std::size_t cullBoxesScalar(const math::frustum& f, const BoundingBoxes& b, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		std::size_t n = 0;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			visible[n] = static_cast<std::uint32_t>(i);
+			n += math::intersects(f, math::float3(b.min_x[i], b.min_y[i], b.min_z[i]), math::float3(b.max_x[i], b.max_y[i], b.max_z[i]));
+		}
+		return n;
+	}
+
+#ifdef CULLING_X86
+	// one index per set bit of the mask, without branching on it
+	inline std::size_t appendVisible(std::uint32_t* visible, std::size_t n, std::size_t first, int mask, int lanes)
+	{
+		for (int k = 0; k < lanes; ++k)
+		{
+			visible[n] = static_cast<std::uint32_t>(first + k);
+			n += (mask >> k) & 1;
+		}
+		return n;
+	}
+
+	std::size_t cullSpheresSSE(const math::frustum& f, const BoundingSpheres& s, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		std::size_t n = 0, i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&s.x[i]), y = _mm_loadu_ps(&s.y[i]), z = _mm_loadu_ps(&s.z[i]);
+			__m128 minus_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&s.radius[i]));
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const math::float4& p : f.planes)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p.x)), _mm_mul_ps(y, _mm_set1_ps(p.y))),
+				                      _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(d, minus_r));
+			}
+
+			n = appendVisible(visible, n, i, _mm_movemask_ps(inside), 4);
+		}
+		return n + cullSpheresScalar(f, s, i, end, visible + n);
+	}
+
+	std::size_t cullBoxesSSE(const math::frustum& f, const BoundingBoxes& b, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		BoxCorners corners(f, b);
+
+		std::size_t n = 0, i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (int p = 0; p < 6; ++p)
+			{
+				const math::float4& plane = f.planes[p];
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(corners.x[p] + i), _mm_set1_ps(plane.x)),
+				                                 _mm_mul_ps(_mm_loadu_ps(corners.y[p] + i), _mm_set1_ps(plane.y))),
+				                      _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(corners.z[p] + i), _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+			}
+
+			n = appendVisible(visible, n, i, _mm_movemask_ps(inside), 4);
+		}
+		return n + cullBoxesScalar(f, b, i, end, visible + n);
+	}
+
+	CULLING_TARGET_AVX std::size_t cullSpheresAVX(const math::frustum& f, const BoundingSpheres& s, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		std::size_t n = 0, i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(&s.x[i]), y = _mm256_loadu_ps(&s.y[i]), z = _mm256_loadu_ps(&s.z[i]);
+			__m256 minus_r = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&s.radius[i]));
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const math::float4& p : f.planes)
+			{
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(p.x)), _mm256_mul_ps(y, _mm256_set1_ps(p.y))),
+				                         _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(p.z)), _mm256_set1_ps(p.w)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, minus_r, _CMP_GE_OQ));
+			}
+
+			n = appendVisible(visible, n, i, _mm256_movemask_ps(inside), 8);
+		}
+		_mm256_zeroupper();
+		return n + cullSpheresScalar(f, s, i, end, visible + n);
+	}
+
+	CULLING_TARGET_AVX std::size_t cullBoxesAVX(const math::frustum& f, const BoundingBoxes& b, std::size_t begin, std::size_t end, std::uint32_t* visible)
+	{
+		BoxCorners corners(f, b);
+
+		std::size_t n = 0, i = begin;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (int p = 0; p < 6; ++p)
+			{
+				const math::float4& plane = f.planes[p];
+				__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(corners.x[p] + i), _mm256_set1_ps(plane.x)),
+				                                       _mm256_mul_ps(_mm256_loadu_ps(corners.y[p] + i), _mm256_set1_ps(plane.y))),
+				                         _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(corners.z[p] + i), _mm256_set1_ps(plane.z)), _mm256_set1_ps(plane.w)));
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+
+			n = appendVisible(visible, n, i, _mm256_movemask_ps(inside), 8);
+		}
+		_mm256_zeroupper();
+		return n + cullBoxesScalar(f, b, i, end, visible + n);
+	}
+
+	bool cpuHasAVX()
+	{
+#if defined(_MSC_VER)
+		// the CPU has it and the OS saves the YMM registers
+		int info[4];
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+		return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+		return __builtin_cpu_supports("avx") != 0;
+#endif
+	}
+#endif
+
+	// the ranges of all workers are culled in place, then moved together
+	template <typename Volumes, typename Cull>
+	void cullParallel(const Volumes& volumes, std::vector<std::uint32_t>& visible, unsigned int workers, Cull cull)
+	{
+		std::size_t count = volumes.size();
+		workers = std::max(1U, workers);
+
+		visible.resize(count);
+		std::vector<std::size_t> found(workers);
+
+		// multiples of 8 keep every worker on the SIMD path but the last
+		std::size_t chunk = ((count + workers - 1) / workers + 7) / 8 * 8;
+
+		parallel::run(workers, [&](unsigned int w)
+		{
+			std::size_t begin = std::min(count, w * chunk), end = std::min(count, begin + chunk);
+			found[w] = cull(begin, end, visible.data() + begin);
+		});
+
+		parallel::compact(visible, chunk, found);
+	}
+}
+
+CullPath bestCullPath()
+{
+#ifdef CULLING_X86
+	static const CullPath best = cpuHasAVX() ? CullPath::AVX : CullPath::SSE;
+	return best;
+#else
+	return CullPath::SCALAR;
+#endif
+}
+
+const char* cullPathName(CullPath path)
+{
+	switch (path)
+	{
+	case CullPath::AVX:
+		return "AVX";
+	case CullPath::SSE:
+		return "SSE";
+	default:
+		return "scalar";
+	}
+}
+
+std::size_t cullSpheres(const math::frustum& frustum, const BoundingSpheres& spheres, std::size_t begin, std::size_t end, std::uint32_t* visible, CullPath path)
+{
+#ifdef CULLING_X86
+	if (path == CullPath::AVX && bestCullPath() == CullPath::AVX)
+		return cullSpheresAVX(frustum, spheres, begin, end, visible);
+	if (path != CullPath::SCALAR)
+		return cullSpheresSSE(frustum, spheres, begin, end, visible);
+#endif
+	return cullSpheresScalar(frustum, spheres, begin, end, visible);
+}
+
+std::size_t cullBoxes(const math::frustum& frustum, const BoundingBoxes& boxes, std::size_t begin, std::size_t end, std::uint32_t* visible, CullPath path)
+{
+#ifdef CULLING_X86
+	if (path == CullPath::AVX && bestCullPath() == CullPath::AVX)
+		return cullBoxesAVX(frustum, boxes, begin, end, visible);
+	if (path != CullPath::SCALAR)
+		return cullBoxesSSE(frustum, boxes, begin, end, visible);
+#endif
+	return cullBoxesScalar(frustum, boxes, begin, end, visible);
+}
+
+void cullSpheres(const math::frustum& frustum, const BoundingSpheres& spheres, std::vector<std::uint32_t>& visible, unsigned int workers, CullPath path)
+{
+	cullParallel(spheres, visible, workers, [&](std::size_t begin, std::size_t end, std::uint32_t* out)
+	{
+		return cullSpheres(frustum, spheres, begin, end, out, path);
+	});
+}
+
+void cullBoxes(const math::frustum& frustum, const BoundingBoxes& boxes, std::vector<std::uint32_t>& visible, unsigned int workers, CullPath path)
+{
+	cullParallel(boxes, visible, workers, [&](std::size_t begin, std::size_t end, std::uint32_t* out)
+	{
+		return cullBoxes(frustum, boxes, begin, end, out, path);
+	});
+}
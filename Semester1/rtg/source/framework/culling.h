@@ -0,0 +1,80 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_CULLING
+#define INCLUDED_FRAMEWORK_CULLING
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+#include "math/frustum.h"
+
+
+// bounding spheres of many objects, one array per component so that the culling loads four or eight
+// objects at once
+struct BoundingSpheres
+{
+	std::vector<float> x, y, z, radius;
+
+	void push_back(const math::float3& center, float r)
+	{
+		x.push_back(center.x);
+		y.push_back(center.y);
+		z.push_back(center.z);
+		radius.push_back(r);
+	}
+
+	void reserve(std::size_t count);
+	void clear();
+	std::size_t size() const { return x.size(); }
+};
+
+// axis aligned bounding boxes in the same layout
+struct BoundingBoxes
+{
+	std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+
+	void push_back(const math::float3& bbox_min, const math::float3& bbox_max)
+	{
+		min_x.push_back(bbox_min.x);
+		min_y.push_back(bbox_min.y);
+		min_z.push_back(bbox_min.z);
+		max_x.push_back(bbox_max.x);
+		max_y.push_back(bbox_max.y);
+		max_z.push_back(bbox_max.z);
+	}
+
+	void reserve(std::size_t count);
+	void clear();
+	std::size_t size() const { return min_x.size(); }
+};
+
+enum class CullPath
+{
+	SCALAR,
+	SSE,  // 4 objects at a time
+	AVX   // 8 objects at a time
+};
+
+// the widest path the CPU runs, checked once
+CullPath bestCullPath();
+const char* cullPathName(CullPath path);
+
+// writes the indices in [begin, end) of the objects that are at least partly inside the frustum to
+// visible, in ascending order, and returns how many there are; visible needs room for end - begin
+std::size_t cullSpheres(const math::frustum& frustum, const BoundingSpheres& spheres, std::size_t begin, std::size_t end,
+                        std::uint32_t* visible, CullPath path = bestCullPath());
+std::size_t cullBoxes(const math::frustum& frustum, const BoundingBoxes& boxes, std::size_t begin, std::size_t end,
+                      std::uint32_t* visible, CullPath path = bestCullPath());
+
+// all objects, split among workers threads; visible is resized to the visible objects
+void cullSpheres(const math::frustum& frustum, const BoundingSpheres& spheres, std::vector<std::uint32_t>& visible,
+                 unsigned int workers = 1, CullPath path = bestCullPath());
+void cullBoxes(const math::frustum& frustum, const BoundingBoxes& boxes, std::vector<std::uint32_t>& visible,
+               unsigned int workers = 1, CullPath path = bestCullPath());
+
+#endif  // INCLUDED_FRAMEWORK_CULLING
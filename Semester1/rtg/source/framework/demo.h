@@ -0,0 +1,51 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_DEMO
+#define INCLUDED_FRAMEWORK_DEMO
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <GL/platform/Window.h>
+#include <GL/platform/Application.h>
+
+
+// the main() of the demos that draw a number of objects: "demo [count]" shows a Renderer(window, count)
+// in a window titled title, "demo --benchmark" runs its benchmark() once instead
+template <typename Renderer>
+int runDemo(int argc, char* argv[], const char* title, std::size_t default_count)
+{
+	try
+	{
+		bool benchmark = argc > 1 && std::strcmp(argv[1], "--benchmark") == 0;
+		std::size_t count = argc > 1 && !benchmark ? std::strtoul(argv[1], nullptr, 10) : default_count;
+
+		GL::platform::Window window(title, 800, 600, 24, 8, false);
+		Renderer renderer(window, count);
+
+		if (benchmark)
+			renderer.benchmark();
+		else
+			GL::platform::run(renderer);
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "error: " << e.what() << std::endl;
+		return -1;
+	}
+	catch (...)
+	{
+		std::cout << "unknown exception" << std::endl;
+		return -128;
+	}
+
+	return 0;
+}
+
+#endif  // INCLUDED_FRAMEWORK_DEMO
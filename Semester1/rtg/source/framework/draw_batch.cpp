@@ -0,0 +1,62 @@
+
+
+
+#include <algorithm>
+
+#include "draw_batch.h"
+
+
+DrawBatch::DrawBatch()
+	: command_buffer(createBuffer()),
+	  draw_buffer(createBuffer()),
+	  capacity(0),
+	  uploaded(0)
+{
+}
+
+void DrawBatch::clear()
+{
+	commands.clear();
+	draws.clear();
+}
+
+std::size_t DrawBatch::add(const PooledMesh& mesh, std::size_t lod, const Instance& draw)
+{
+	const MeshLod& range = mesh.lods[std::min(lod, mesh.lods.size() - 1)];
+
+	// the base instance is the draw index, that is where it comes from without gl_DrawID
+	GLuint index = static_cast<GLuint>(commands.size());
+	commands.push_back(DrawElementsIndirectCommand { range.index_count, 1, range.index_offset, mesh.base_vertex, index });
+	draws.push_back(draw);
+
+	return index;
+}
+
+void DrawBatch::upload(GeometryPool& pool)
+{
+	if (commands.size() > capacity)
+		capacity = commands.size();
+
+	pool.reserveDraws(capacity);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, draw_buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, draws.size() * sizeof(Instance), draws.data());
+
+	uploaded = commands.size();
+}
+
+void DrawBatch::submit(const GeometryPool& pool, GLuint storage_binding) const
+{
+	if (uploaded == 0)
+		return;
+
+	pool.bind();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, storage_binding, draw_buffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(uploaded), 0);
+}
@@ -0,0 +1,66 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_DRAW_BATCH
+#define INCLUDED_FRAMEWORK_DRAW_BATCH
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include "gl_objects.h"
+#include "instancing.h"
+#include "geometry_pool.h"
+
+
+// the record glMultiDrawElementsIndirect reads for every draw
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 5 * 4, "indirect commands must be tightly packed");
+
+// draws of pooled meshes collected on the CPU and submitted with one glMultiDrawElementsIndirect;
+// every draw has an Instance of its own in a shader storage buffer, which the shader finds at
+// DRAW_INDEX, as
+//   struct Draw { vec4 transform[3]; vec4 color; };
+//   layout(std430, binding = N) readonly buffer Draws { Draw draws[]; };
+class DrawBatch
+{
+private:
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<Instance> draws;
+
+	Buffer command_buffer;
+	Buffer draw_buffer;
+	std::size_t capacity;
+	std::size_t uploaded;
+
+public:
+	DrawBatch();
+
+	void clear();
+
+	// a draw of the given LOD of a pooled mesh; returns its draw index
+	std::size_t add(const PooledMesh& mesh, std::size_t lod, const Instance& draw);
+
+	// the per-draw data can be changed in place until the next upload()
+	Instance& draw(std::size_t i) { return draws[i]; }
+	std::size_t size() const { return commands.size(); }
+
+	// copies commands and per-draw data to their buffers, orphaning the previous ones
+	void upload(GeometryPool& pool);
+
+	// one call for the whole batch as of the last upload(), with the pool bound and the per-draw data at the given binding
+	void submit(const GeometryPool& pool, GLuint storage_binding) const;
+};
+
+#endif  // INCLUDED_FRAMEWORK_DRAW_BATCH
@@ -0,0 +1,16 @@
+
+
+
+#include "frame_uniforms.h"
+
+
+void setFrameUniforms(GLuint buffer, const math::float4x4& view, const math::float4x4& projection, const math::float3& light_direction)
+{
+	FrameUniforms uniforms;
+	uniforms.view = view;
+	uniforms.projection = projection;
+	uniforms.light_direction = math::float4(normalize(light_direction), 0.0f);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+}
@@ -0,0 +1,36 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_FRAME_UNIFORMS
+#define INCLUDED_FRAMEWORK_FRAME_UNIFORMS
+
+#pragma once
+
+#include <cstddef>
+
+#include <GL/gl.h>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+#include "std140.h"
+
+
+// camera and light, the same for everything drawn in a frame; the shaders declare it as
+// layout(std140) uniform Frame { mat4 View; mat4 Projection; vec4 LightDirection; };
+struct FrameUniforms
+{
+	std140::member<math::float4x4> view;
+	std140::member<math::float4x4> projection;
+	std140::member<math::float4> light_direction;
+};
+
+typedef std140::layout<math::float4x4, math::float4x4, math::float4> FrameLayout;
+static_assert(offsetof(FrameUniforms, projection) == FrameLayout::offset<1>(), "FrameUniforms does not follow std140");
+static_assert(offsetof(FrameUniforms, light_direction) == FrameLayout::offset<2>(), "FrameUniforms does not follow std140");
+static_assert(sizeof(FrameUniforms) == FrameLayout::size, "FrameUniforms does not follow std140");
+
+// writes the frame uniforms to the start of a uniform buffer, the light direction is normalized here
+void setFrameUniforms(GLuint buffer, const math::float4x4& view, const math::float4x4& projection,
+                      const math::float3& light_direction = math::float3(0.4f, 1.0f, 0.3f));
+
+#endif  // INCLUDED_FRAMEWORK_FRAME_UNIFORMS
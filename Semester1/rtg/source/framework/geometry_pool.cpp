@@ -0,0 +1,123 @@
+
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gl_support.h"
+#include "geometry_pool.h"
+
+
+GeometryPool::GeometryPool()
+	: vao(createVertexArray()),
+	  draw_index_capacity(0),
+	  draw_parameters(glVersionAtLeast(4, 6) || hasGLExtension("GL_ARB_shader_draw_parameters")),
+	  vertex_count(0),
+	  index_count(0),
+	  uploaded(false)
+{
+}
+
+std::size_t GeometryPool::add(const Vertex* mesh_vertices, std::size_t mesh_vertex_count, const void* mesh_indices, std::size_t mesh_index_count, std::size_t index_size,
+                              const MeshLod* lods, std::size_t lod_count, const math::float3& bbox_min, const math::float3& bbox_max)
+{
+	if (uploaded)
+		throw std::runtime_error("geometry pool is already uploaded");
+
+	PooledMesh mesh;
+	mesh.base_vertex = static_cast<GLint>(vertices.size());
+	mesh.bbox_min = bbox_min;
+	mesh.bbox_max = bbox_max;
+
+	std::uint32_t base_index = static_cast<std::uint32_t>(indices.size());
+	for (std::size_t i = 0; i < lod_count; ++i)
+		mesh.lods.push_back(MeshLod { base_index + lods[i].index_offset, lods[i].index_count, lods[i].error });
+
+	vertices.insert(vertices.end(), mesh_vertices, mesh_vertices + mesh_vertex_count);
+
+	// indices stay relative to the mesh, the base vertex of the draw moves them
+	indices.reserve(indices.size() + mesh_index_count);
+	if (index_size == 2)
+	{
+		const std::uint16_t* p = static_cast<const std::uint16_t*>(mesh_indices);
+		indices.insert(indices.end(), p, p + mesh_index_count);
+	}
+	else
+	{
+		const std::uint32_t* p = static_cast<const std::uint32_t*>(mesh_indices);
+		indices.insert(indices.end(), p, p + mesh_index_count);
+	}
+
+	vertex_count = vertices.size();
+	index_count = indices.size();
+
+	meshes.push_back(std::move(mesh));
+	return meshes.size() - 1;
+}
+
+std::size_t GeometryPool::add(const CachedMesh& mesh)
+{
+	return add(mesh.vertices(), mesh.vertexCount(), mesh.indices(), mesh.indexCount(), mesh.indexSize(), mesh.lods(), mesh.lodCount(), mesh.bboxMin(), mesh.bboxMax());
+}
+
+std::size_t GeometryPool::add(const IndexedMesh& mesh)
+{
+	MeshLod lod = { 0, static_cast<std::uint32_t>(mesh.indices.size()), 0.0f };
+	return add(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size(), 4, &lod, 1, mesh.bbox_min, mesh.bbox_max);
+}
+
+void GeometryPool::upload()
+{
+	if (uploaded)
+		return;
+
+	glBindVertexArray(vao);
+
+	vertex_buffer = createBuffer(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data());
+	MeshVertexFormat::configure();
+
+	index_buffer = createBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data());
+
+	glBindVertexArray(0);
+
+	// the GL has its own copy now
+	std::vector<Vertex>().swap(vertices);
+	std::vector<std::uint32_t>().swap(indices);
+
+	uploaded = true;
+}
+
+const char* GeometryPool::drawIndexGLSL() const
+{
+	if (draw_parameters)
+		return "#extension GL_ARB_shader_draw_parameters : require\n"
+		       "#define DRAW_INDEX uint(gl_DrawIDARB)\n";
+
+	static_assert(draw_index_location == 3, "the draw index location in the GLSL is out of date");
+	return "layout(location = 3) in uint drawIndex;\n"
+	       "#define DRAW_INDEX drawIndex\n";
+}
+
+void GeometryPool::reserveDraws(std::size_t count)
+{
+	if (draw_parameters || count <= draw_index_capacity)
+		return;
+
+	draw_index_capacity = std::max(count, 2 * draw_index_capacity);
+
+	std::vector<GLuint> draw_indices(draw_index_capacity);
+	for (std::size_t i = 0; i < draw_index_capacity; ++i)
+		draw_indices[i] = static_cast<GLuint>(i);
+
+	glBindVertexArray(vao);
+	draw_index_buffer = createBuffer(GL_ARRAY_BUFFER, draw_indices.size() * sizeof(GLuint), draw_indices.data());
+	glEnableVertexAttribArray(draw_index_location);
+	glVertexAttribIPointer(draw_index_location, 1, GL_UNSIGNED_INT, 0, nullptr);
+	glVertexAttribDivisor(draw_index_location, 1);
+	glBindVertexArray(0);
+}
+
+void GeometryPool::bind() const
+{
+	glBindVertexArray(vao);
+}
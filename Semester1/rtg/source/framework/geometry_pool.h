@@ -0,0 +1,92 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GEOMETRY_POOL
+#define INCLUDED_FRAMEWORK_GEOMETRY_POOL
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include "mesh.h"
+#include "mesh_lod.h"
+#include "mesh_cache.h"
+#include "gl_objects.h"
+#include "vertex_format.h"
+
+
+typedef vertex_format<attribute::position<math::float3>, attribute::normal<math::float3>, attribute::uv<math::float2>> MeshVertexFormat;
+static_assert(MeshVertexFormat::stride == sizeof(Vertex), "vertex format does not match the mesh vertices");
+static_assert(MeshVertexFormat::offset<1>() == offsetof(Vertex, normal) && MeshVertexFormat::offset<2>() == offsetof(Vertex, texcoord), "vertex format does not match the mesh vertices");
+
+// where a mesh ended up in the pool; the LOD offsets count from the start of the pooled index buffer
+struct PooledMesh
+{
+	GLint base_vertex;
+	std::vector<MeshLod> lods;
+	math::float3 bbox_min;
+	math::float3 bbox_max;
+};
+
+// static meshes packed into one vertex buffer and one 32-bit index buffer behind a single vertex
+// array, so that any of them is drawn without binding anything else; meshes are added first, then
+// the pool is uploaded once
+class GeometryPool
+{
+private:
+	VertexArray vao;
+	Buffer vertex_buffer;
+	Buffer index_buffer;
+
+	// consecutive integers read per instance, for drivers without gl_DrawID (see drawIndexGLSL())
+	Buffer draw_index_buffer;
+	std::size_t draw_index_capacity;
+	bool draw_parameters;
+
+	std::vector<Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+	std::vector<PooledMesh> meshes;
+	std::size_t vertex_count;
+	std::size_t index_count;
+	bool uploaded;
+
+	std::size_t add(const Vertex* mesh_vertices, std::size_t mesh_vertex_count, const void* mesh_indices, std::size_t mesh_index_count, std::size_t index_size,
+	                const MeshLod* lods, std::size_t lod_count, const math::float3& bbox_min, const math::float3& bbox_max);
+
+public:
+	// the attribute the draw index arrives in when the shader has no gl_DrawID
+	static const GLuint draw_index_location = MeshVertexFormat::location_count;
+
+	GeometryPool();
+
+	// returns the number of the mesh in the pool
+	std::size_t add(const CachedMesh& mesh);
+	std::size_t add(const IndexedMesh& mesh);
+
+	// moves everything added to the GPU and frees the copies; nothing can be added afterwards
+	void upload();
+
+	const PooledMesh& mesh(std::size_t i) const { return meshes[i]; }
+	std::size_t meshCount() const { return meshes.size(); }
+	std::size_t vertexCount() const { return vertex_count; }
+	std::size_t indexCount() const { return index_count; }
+
+	// true if shaders can use gl_DrawIDARB; otherwise the draw index comes in as a vertex attribute
+	// that advances with the base instance of every draw
+	bool drawParameters() const { return draw_parameters; }
+
+	// GLSL to put right after the #version line, defining DRAW_INDEX as the number of the draw in a
+	// multi-draw call
+	const char* drawIndexGLSL() const;
+
+	// makes sure the draw index attribute reaches count draws (without gl_DrawID)
+	void reserveDraws(std::size_t count);
+
+	void bind() const;
+};
+
+#endif  // INCLUDED_FRAMEWORK_GEOMETRY_POOL
@@ -0,0 +1,169 @@
+
+
+
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <iostream>
+#include <unordered_set>
+
+#include "gl_support.h"
+#include "gl_diagnostics.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+
+namespace
+{
+	bool debug_output = false;
+
+	// the callback may come from a driver thread unless the output is synchronous
+	std::atomic<bool> error_pending(false);
+	std::mutex mutex;
+	std::string error_message;
+
+	// other than errors, every message is logged the first time only, the same warning could come every frame
+	std::unordered_set<std::uint64_t> logged;
+
+	const char* sourceName(GLenum source)
+	{
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API:
+			return "API";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+			return "window system";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER:
+			return "shader compiler";
+		case GL_DEBUG_SOURCE_THIRD_PARTY:
+			return "third party";
+		case GL_DEBUG_SOURCE_APPLICATION:
+			return "application";
+		default:
+			return "other";
+		}
+	}
+
+	const char* typeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR:
+			return "error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+			return "deprecated behavior";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+			return "undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY:
+			return "portability";
+		case GL_DEBUG_TYPE_PERFORMANCE:
+			return "performance";
+		default:
+			return "other";
+		}
+	}
+
+	void APIENTRY debugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void*)
+	{
+		std::string text(message, length >= 0 ? static_cast<std::size_t>(length) : std::char_traits<char>::length(message));
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::uint64_t key = (static_cast<std::uint64_t>(source) << 48) ^ (static_cast<std::uint64_t>(type) << 32) ^ id;
+		if (type == GL_DEBUG_TYPE_ERROR || logged.insert(key).second)
+			std::cerr << "GL " << sourceName(source) << " " << typeName(type) << " " << id
+			          << (severity == GL_DEBUG_SEVERITY_HIGH ? " (high)" : "") << ": " << text << std::endl;
+
+		// only the first error is thrown, the rest is in the log
+		if (type == GL_DEBUG_TYPE_ERROR && !error_pending.load(std::memory_order_relaxed))
+		{
+			error_message = text;
+			error_pending.store(true, std::memory_order_release);
+		}
+	}
+}
+
+GLException::GLException(GLenum error)
+	: std::runtime_error(glErrorString(error)),
+	  error(error)
+{
+}
+
+GLException::GLException(GLenum error, const std::string& message)
+	: std::runtime_error(message),
+	  error(error)
+{
+}
+
+const char* glErrorString(GLenum error)
+{
+	switch (error)
+	{
+	case GL_NO_ERROR:
+		return "No error.";
+	case GL_INVALID_ENUM:
+		return "Enumeration parameter is not a legal enumeration for that function.";
+	case GL_INVALID_VALUE:
+		return "Illegal parameter value for that function.";
+	case GL_INVALID_OPERATION:
+		return "This operation cannot be executed in the current state of OpenGL.";
+	case GL_STACK_OVERFLOW:
+		return "Stack overflow occurred.";
+	case GL_STACK_UNDERFLOW:
+		return "Stack underflow occurred.";
+	case GL_OUT_OF_MEMORY:
+		return "Out of memory.";
+	case GL_INVALID_FRAMEBUFFER_OPERATION:
+		return "Operation could not be performed in the current state of the frame buffer.";
+	default:
+		return "Unknown error! Please check error code!";
+	}
+}
+
+bool installGLDebugOutput(bool synchronous)
+{
+	if (!glVersionAtLeast(4, 3) && !hasGLExtension("GL_KHR_debug"))
+		return debug_output = false;
+
+	glDebugMessageCallback(debugMessage, nullptr);
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+	glEnable(GL_DEBUG_OUTPUT);
+	setGLDebugSynchronous(synchronous);
+
+	return debug_output = true;
+}
+
+void setGLDebugSynchronous(bool synchronous)
+{
+	if (synchronous)
+		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	else
+		glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+}
+
+void checkGLError()
+{
+	if (!debug_output)
+	{
+		GLenum error = glGetError();
+		if (error != GL_NO_ERROR)
+			throw GLException(error);
+		return;
+	}
+
+	if (!error_pending.load(std::memory_order_acquire))
+		return;
+
+	std::string message;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		message.swap(error_message);
+		error_pending.store(false, std::memory_order_relaxed);
+	}
+
+	throw GLException(GL_NO_ERROR, message);
+}
@@ -0,0 +1,60 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GL_DIAGNOSTICS
+#define INCLUDED_FRAMEWORK_GL_DIAGNOSTICS
+
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+#include <GL/gl.h>
+
+
+// a GL error, from glGetError or from a debug message of type error; the latter do not say which
+// error code they stand for, their code() is GL_NO_ERROR
+class GLException : public std::runtime_error
+{
+private:
+	GLenum error;
+
+public:
+	explicit GLException(GLenum error);
+	GLException(GLenum error, const std::string& message);
+
+	GLenum code() const { return error; }
+};
+
+const char* glErrorString(GLenum error);
+
+// has the debug context report through glDebugMessageCallback: messages go to std::cerr, errors are also
+// kept for checkGLError(); notifications are left out. false if the context has neither GL 4.3 nor
+// KHR_debug, then checkGLError() falls back to glGetError(). synchronous makes the GL report every
+// message from within the call that caused it, which pins errors down to the call but may cost a
+// pipeline sync per call; meant to be switched on while hunting an error
+bool installGLDebugOutput(bool synchronous = false);
+void setGLDebugSynchronous(bool synchronous);
+
+// throws a GLException for the first error reported since the last check
+void checkGLError();
+
+// debug builds check for errors after the call, which only looks at what the debug callback kept,
+// unless there is no debug output; release builds make the call and nothing else
+#ifdef _DEBUG
+#define GL_SAFE_CALL(A) ([&]                \
+{                                           \
+	struct error_guard                      \
+	{                                       \
+		~error_guard() noexcept(false)      \
+		{                                   \
+			checkGLError();                 \
+		}                                   \
+	} guard;                                \
+	return A;                               \
+}())
+#else
+#define GL_SAFE_CALL(A) (A)
+#endif
+
+#endif  // INCLUDED_FRAMEWORK_GL_DIAGNOSTICS
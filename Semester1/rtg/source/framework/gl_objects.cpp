@@ -0,0 +1,46 @@
+
+
+
+#include "gl_objects.h"
+
+
+Buffer createBuffer()
+{
+	GLuint name;
+	glGenBuffers(1, &name);
+	return Buffer(name);
+}
+
+VertexArray createVertexArray()
+{
+	GLuint name;
+	glGenVertexArrays(1, &name);
+	return VertexArray(name);
+}
+
+Texture createTexture()
+{
+	GLuint name;
+	glGenTextures(1, &name);
+	return Texture(name);
+}
+
+Program createProgram()
+{
+	return Program(glCreateProgram());
+}
+
+Query createQuery()
+{
+	GLuint name;
+	glGenQueries(1, &name);
+	return Query(name);
+}
+
+Buffer createBuffer(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	Buffer buffer = createBuffer();
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, data, usage);
+	return buffer;
+}
@@ -0,0 +1,114 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GL_OBJECTS
+#define INCLUDED_FRAMEWORK_GL_OBJECTS
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <GL/gl.h>
+
+
+namespace detail
+{
+	struct BufferTraits
+	{
+		static void destroy(GLuint name) { glDeleteBuffers(1, &name); }
+	};
+
+	struct VertexArrayTraits
+	{
+		static void destroy(GLuint name) { glDeleteVertexArrays(1, &name); }
+	};
+
+	struct TextureTraits
+	{
+		static void destroy(GLuint name) { glDeleteTextures(1, &name); }
+	};
+
+	struct ProgramTraits
+	{
+		static void destroy(GLuint name) { glDeleteProgram(name); }
+	};
+
+	struct QueryTraits
+	{
+		static void destroy(GLuint name) { glDeleteQueries(1, &name); }
+	};
+}
+
+// move-only owner of one GL object name, deleted with the handle; the context it was made in has to
+// be current then. keeps count of the live objects of its kind, to catch per-frame leaks
+template <typename Traits>
+class GLObject
+{
+private:
+	GLuint name;
+
+	static std::size_t live;
+
+public:
+	GLObject(const GLObject&) = delete;
+	GLObject& operator =(const GLObject&) = delete;
+
+	GLObject()
+		: name(0)
+	{
+	}
+
+	explicit GLObject(GLuint name)
+		: name(name)
+	{
+		if (name)
+			++live;
+	}
+
+	GLObject(GLObject&& o)
+		: name(o.name)
+	{
+		o.name = 0;
+	}
+
+	~GLObject()
+	{
+		if (name)
+		{
+			Traits::destroy(name);
+			--live;
+		}
+	}
+
+	GLObject& operator =(GLObject&& o)
+	{
+		using std::swap;
+		swap(name, o.name);
+		return *this;
+	}
+
+	operator GLuint() const { return name; }
+
+	static std::size_t liveCount() { return live; }
+};
+
+template <typename Traits>
+std::size_t GLObject<Traits>::live = 0;
+
+typedef GLObject<detail::BufferTraits> Buffer;
+typedef GLObject<detail::VertexArrayTraits> VertexArray;
+typedef GLObject<detail::TextureTraits> Texture;
+typedef GLObject<detail::ProgramTraits> Program;
+typedef GLObject<detail::QueryTraits> Query;
+
+Buffer createBuffer();
+VertexArray createVertexArray();
+Texture createTexture();
+Program createProgram();
+Query createQuery();
+
+// a buffer filled with size bytes of data, left bound to target
+Buffer createBuffer(GLenum target, GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW);
+
+#endif  // INCLUDED_FRAMEWORK_GL_OBJECTS
@@ -0,0 +1,199 @@
+
+
+
+#include "gl_state.h"
+
+
+namespace
+{
+	inline std::uint64_t slot(GLenum target, GLuint index)
+	{
+		return (static_cast<std::uint64_t>(target) << 32) | index;
+	}
+
+	template <typename Map, typename Unbound>
+	void eraseIf(Map& map, Unbound unbound)
+	{
+		for (auto i = map.begin(); i != map.end();)
+			if (unbound(i->second))
+				i = map.erase(i);
+			else
+				++i;
+	}
+}
+
+GLStateCache::GLStateCache()
+	: frame(GLStateCounters { 0, 0 }),
+	  last_frame(GLStateCounters { 0, 0 })
+{
+	invalidate();
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (change(!program_known || this->program != program))
+	{
+		glUseProgram(program);
+		this->program = program;
+		program_known = true;
+	}
+}
+
+void GLStateCache::bindVertexArray(GLuint vertex_array)
+{
+	if (change(!vertex_array_known || this->vertex_array != vertex_array))
+	{
+		glBindVertexArray(vertex_array);
+		this->vertex_array = vertex_array;
+		vertex_array_known = true;
+		buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+	}
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	auto bound = buffers.find(target);
+	if (change(bound == buffers.end() || bound->second != buffer))
+	{
+		glBindBuffer(target, buffer);
+		buffers[target] = buffer;
+	}
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	// the whole buffer, whatever size it has now
+	bindBufferRange(target, index, buffer, 0, -1);
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	auto bound = indexed_buffers.find(slot(target, index));
+	if (change(bound == indexed_buffers.end() || bound->second.buffer != buffer || bound->second.offset != offset || bound->second.size != size))
+	{
+		if (size < 0)
+			glBindBufferBase(target, index, buffer);
+		else
+			glBindBufferRange(target, index, buffer, offset, size);
+		indexed_buffers[slot(target, index)] = IndexedBinding { buffer, offset, size };
+
+		// both also bind the buffer to the generic binding point of the target
+		buffers[target] = buffer;
+	}
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+	if (change(!active_texture_known || active_texture != unit))
+	{
+		glActiveTexture(unit);
+		active_texture = unit;
+		active_texture_known = true;
+	}
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	// without a known unit there is no telling which binding changes
+	if (!active_texture_known)
+	{
+		change(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	std::uint64_t key = slot(target, active_texture);
+	auto bound = textures.find(key);
+	if (change(bound == textures.end() || bound->second != texture))
+	{
+		glBindTexture(target, texture);
+		textures[key] = texture;
+	}
+}
+
+void GLStateCache::enable(GLenum capability)
+{
+	auto flag = capabilities.find(capability);
+	if (change(flag == capabilities.end() || !flag->second))
+	{
+		glEnable(capability);
+		capabilities[capability] = true;
+	}
+}
+
+void GLStateCache::disable(GLenum capability)
+{
+	auto flag = capabilities.find(capability);
+	if (change(flag == capabilities.end() || flag->second))
+	{
+		glDisable(capability);
+		capabilities[capability] = false;
+	}
+}
+
+void GLStateCache::depthMask(GLboolean flag)
+{
+	if (change(!depth_mask_known || depth_mask != flag))
+	{
+		glDepthMask(flag);
+		depth_mask = flag;
+		depth_mask_known = true;
+	}
+}
+
+void GLStateCache::blendFunc(GLenum src, GLenum dst)
+{
+	if (change(!blend_func_known || blend_src != src || blend_dst != dst))
+	{
+		glBlendFunc(src, dst);
+		blend_src = src;
+		blend_dst = dst;
+		blend_func_known = true;
+	}
+}
+
+void GLStateCache::invalidate()
+{
+	program_known = false;
+	vertex_array_known = false;
+	active_texture_known = false;
+	depth_mask_known = false;
+	blend_func_known = false;
+
+	buffers.clear();
+	indexed_buffers.clear();
+	textures.clear();
+	capabilities.clear();
+}
+
+void GLStateCache::forgetProgram(GLuint program)
+{
+	if (program_known && this->program == program)
+		program_known = false;
+}
+
+void GLStateCache::forgetVertexArray(GLuint vertex_array)
+{
+	if (vertex_array_known && this->vertex_array == vertex_array)
+	{
+		vertex_array_known = false;
+		buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+	}
+}
+
+void GLStateCache::forgetBuffer(GLuint buffer)
+{
+	eraseIf(buffers, [buffer](GLuint b) { return b == buffer; });
+	eraseIf(indexed_buffers, [buffer](const IndexedBinding& b) { return b.buffer == buffer; });
+}
+
+void GLStateCache::forgetTexture(GLuint texture)
+{
+	eraseIf(textures, [texture](GLuint t) { return t == texture; });
+}
+
+void GLStateCache::beginFrame()
+{
+	last_frame = frame;
+	frame = GLStateCounters { 0, 0 };
+}
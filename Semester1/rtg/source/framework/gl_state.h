@@ -0,0 +1,105 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GL_STATE
+#define INCLUDED_FRAMEWORK_GL_STATE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include <GL/gl.h>
+
+
+// calls made through a GLStateCache, and how many of them were left out
+struct GLStateCounters
+{
+	std::size_t issued;
+	std::size_t elided;
+
+	std::size_t calls() const { return issued + elided; }
+};
+
+// mirrors the bindings and flags set through it and leaves out every call that would not change them;
+// nothing is known at the start, so the first call of each kind always goes through. whatever changes
+// the state behind its back has to be followed by invalidate(), and a deleted object by the forget
+// call of its kind. binding a vertex array also binds its element array buffer, which is therefore
+// unknown afterwards
+class GLStateCache
+{
+private:
+	struct IndexedBinding
+	{
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	GLuint program;
+	bool program_known;
+	GLuint vertex_array;
+	bool vertex_array_known;
+	GLenum active_texture;
+	bool active_texture_known;
+
+	std::unordered_map<GLenum, GLuint> buffers;
+	std::unordered_map<std::uint64_t, IndexedBinding> indexed_buffers;
+	std::unordered_map<std::uint64_t, GLuint> textures;
+	std::unordered_map<GLenum, bool> capabilities;
+
+	GLboolean depth_mask;
+	bool depth_mask_known;
+	GLenum blend_src;
+	GLenum blend_dst;
+	bool blend_func_known;
+
+	GLStateCounters frame;
+	GLStateCounters last_frame;
+
+	// counts the call and tells whether it has to be made
+	bool change(bool differs)
+	{
+		++(differs ? frame.issued : frame.elided);
+		return differs;
+	}
+
+public:
+	GLStateCache(const GLStateCache&) = delete;
+	GLStateCache& operator =(const GLStateCache&) = delete;
+
+	GLStateCache();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertex_array);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	void activeTexture(GLenum unit);
+	void bindTexture(GLenum target, GLuint texture);
+
+	void enable(GLenum capability);
+	void disable(GLenum capability);
+	void depthMask(GLboolean flag);
+	void blendFunc(GLenum src, GLenum dst);
+
+	// everything is unknown again
+	void invalidate();
+
+	// wherever the name is mirrored, the binding becomes unknown; for objects that are deleted, as the
+	// GL unbinds them or hands their name out again
+	void forgetProgram(GLuint program);
+	void forgetVertexArray(GLuint vertex_array);
+	void forgetBuffer(GLuint buffer);
+	void forgetTexture(GLuint texture);
+
+	// starts counting the calls of a new frame
+	void beginFrame();
+
+	// the calls since beginFrame(), and those of the frame before it
+	const GLStateCounters& frameCounters() const { return frame; }
+	const GLStateCounters& lastFrameCounters() const { return last_frame; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_GL_STATE
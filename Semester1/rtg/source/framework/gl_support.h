@@ -0,0 +1,16 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GL_SUPPORT
+#define INCLUDED_FRAMEWORK_GL_SUPPORT
+
+#pragma once
+
+#include <GL/gl.h>
+
+
+// what the current context can do, for features beyond the version the tasks ask for
+bool glVersionAtLeast(int major, int minor);
+bool hasGLExtension(const char* name);
+
+#endif  // INCLUDED_FRAMEWORK_GL_SUPPORT
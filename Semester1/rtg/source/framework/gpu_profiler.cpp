@@ -0,0 +1,188 @@
+
+
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "gpu_profiler.h"
+
+
+GPUProfiler::GPUProfiler(unsigned int latency, std::size_t window)
+	: latency(latency ? latency : 1),
+	  window(window ? window : 1),
+	  frame_number(0),
+	  dropped(0)
+{
+	current.number = 0;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	if (!zones.empty())
+		report(std::cout);
+}
+
+GLuint GPUProfiler::timestamp()
+{
+	if (free_queries.empty())
+	{
+		queries.push_back(createQuery());
+		free_queries.push_back(queries.back());
+	}
+
+	GLuint query = free_queries.back();
+	free_queries.pop_back();
+	glQueryCounter(query, GL_TIMESTAMP);
+	return query;
+}
+
+void GPUProfiler::release(const Frame& frame)
+{
+	for (const Range& range : frame.ranges)
+	{
+		free_queries.push_back(range.begin);
+		free_queries.push_back(range.end);
+	}
+}
+
+void GPUProfiler::collect(const Frame& frame)
+{
+	// a zone may show up more than once in a frame, its sample is the sum
+	std::vector<double> frame_ms(zones.size(), -1.0);
+
+	for (const Range& range : frame.ranges)
+	{
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(range.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(range.end, GL_QUERY_RESULT, &end);
+
+		double ms = end > begin ? (end - begin) * 1e-6 : 0.0;
+		frame_ms[range.zone] = std::max(frame_ms[range.zone], 0.0) + ms;
+	}
+
+	for (std::size_t i = 0; i < zones.size(); ++i)
+	{
+		if (frame_ms[i] < 0.0)
+			continue;
+
+		Zone& zone = zones[i];
+		if (zone.samples.size() < window)
+			zone.samples.push_back(frame_ms[i]);
+		else
+			zone.samples[zone.next] = frame_ms[i];
+		zone.next = (zone.next + 1) % window;
+		++zone.count;
+	}
+}
+
+void GPUProfiler::beginFrame()
+{
+	while (!pending.empty() && frame_number - pending.front().number >= latency)
+	{
+		const Frame& frame = pending.front();
+
+		// timestamps are written in order, the frame is done once its last one is
+		if (!frame.ranges.empty())
+		{
+			GLuint available = GL_FALSE;
+			glGetQueryObjectuiv(frame.ranges.back().end, GL_QUERY_RESULT_AVAILABLE, &available);
+
+			if (!available)
+			{
+				if (pending.size() <= 2 * latency)
+					break;
+				++dropped;
+				release(frame);
+				pending.pop_front();
+				continue;
+			}
+		}
+
+		collect(frame);
+		release(frame);
+		pending.pop_front();
+	}
+}
+
+void GPUProfiler::endFrame()
+{
+	for (Zone& zone : zones)
+		if (zone.open)
+		{
+			free_queries.push_back(zone.open);
+			zone.open = 0;
+		}
+
+	current.number = frame_number++;
+	pending.push_back(std::move(current));
+	current.ranges.clear();
+}
+
+std::size_t GPUProfiler::zone(const std::string& name)
+{
+	auto found = zone_ids.find(name);
+	if (found != zone_ids.end())
+		return found->second;
+
+	zones.push_back(Zone { name, std::vector<double>(), 0, 0, 0 });
+	zones.back().samples.reserve(window);
+	zone_ids.insert(std::make_pair(name, zones.size() - 1));
+	return zones.size() - 1;
+}
+
+void GPUProfiler::begin(std::size_t zone)
+{
+	Zone& z = zones[zone];
+	if (z.open)
+		free_queries.push_back(z.open);
+	z.open = timestamp();
+}
+
+void GPUProfiler::end(std::size_t zone)
+{
+	Zone& z = zones[zone];
+	if (!z.open)
+		return;
+
+	current.ranges.push_back(Range { zone, z.open, timestamp() });
+	z.open = 0;
+}
+
+GPUProfiler::Statistics GPUProfiler::statistics(std::size_t zone) const
+{
+	const Zone& z = zones[zone];
+
+	Statistics s = { z.samples.size(), 0.0, 0.0, 0.0, 0.0 };
+	if (z.samples.empty())
+		return s;
+
+	std::vector<double> sorted(z.samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum = 0.0;
+	for (double ms : sorted)
+		sum += ms;
+
+	s.min_ms = sorted.front();
+	s.avg_ms = sum / sorted.size();
+	s.p99_ms = sorted[static_cast<std::size_t>(std::ceil(0.99 * sorted.size())) - 1];
+	s.last_ms = z.samples[(z.next + z.samples.size() - 1) % z.samples.size()];
+	return s;
+}
+
+void GPUProfiler::report(std::ostream& out) const
+{
+	out << "GPU zones over the last " << window << " frames at most, " << dropped << " frames dropped" << std::endl;
+	out << std::setw(24) << std::left << "zone" << std::right << std::setw(10) << "frames"
+	    << std::setw(10) << "min ms" << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::endl;
+
+	for (std::size_t i = 0; i < zones.size(); ++i)
+	{
+		Statistics s = statistics(i);
+		out << std::setw(24) << std::left << zones[i].name << std::right << std::setw(10) << zones[i].count
+		    << std::fixed << std::setprecision(3)
+		    << std::setw(10) << s.min_ms << std::setw(10) << s.avg_ms << std::setw(10) << s.p99_ms << std::endl;
+	}
+}
@@ -0,0 +1,140 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_GPU_PROFILER
+#define INCLUDED_FRAMEWORK_GPU_PROFILER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/gl.h>
+
+#include "gl_objects.h"
+
+
+// GPU time spent on named parts of the frame, measured with a GL_TIMESTAMP query where a zone begins
+// and one where it ends, so zones may nest and overlap. the queries come from a pool and are read
+// back latency frames later, once the GPU got past them; a frame whose queries are still not done
+// by then is left for later, and dropped should it fall more than twice that far behind, so that
+// reading never waits for the GPU. every zone keeps its time per frame over the last window frames
+// it showed up in; the statistics are printed to std::cout when the profiler goes away. a zone has to
+// end before it begins again, and one still open at the end of the frame is not counted
+class GPUProfiler
+{
+public:
+	struct Statistics
+	{
+		std::size_t samples;
+		double min_ms;
+		double avg_ms;
+		double p99_ms;
+		double last_ms;
+	};
+
+private:
+	struct Zone
+	{
+		std::string name;
+		std::vector<double> samples;
+		std::size_t next;
+		std::size_t count;
+		GLuint open;
+	};
+
+	struct Range
+	{
+		std::size_t zone;
+		GLuint begin;
+		GLuint end;
+	};
+
+	struct Frame
+	{
+		std::uint64_t number;
+		std::vector<Range> ranges;
+	};
+
+	unsigned int latency;
+	std::size_t window;
+
+	std::vector<Query> queries;
+	std::vector<GLuint> free_queries;
+
+	std::vector<Zone> zones;
+	std::unordered_map<std::string, std::size_t> zone_ids;
+
+	Frame current;
+	std::deque<Frame> pending;
+	std::uint64_t frame_number;
+	std::size_t dropped;
+
+	GLuint timestamp();
+	void release(const Frame& frame);
+	void collect(const Frame& frame);
+
+public:
+	GPUProfiler(const GPUProfiler&) = delete;
+	GPUProfiler& operator =(const GPUProfiler&) = delete;
+
+	explicit GPUProfiler(unsigned int latency = 3, std::size_t window = 256);
+	~GPUProfiler();
+
+	// reads back the frames that are done and at least latency frames old
+	void beginFrame();
+
+	// the zones of this frame are complete, its queries go to the GPU
+	void endFrame();
+
+	// the zone of that name, made on first use
+	std::size_t zone(const std::string& name);
+
+	void begin(std::size_t zone);
+	void end(std::size_t zone);
+
+	std::size_t zoneCount() const { return zones.size(); }
+	const std::string& zoneName(std::size_t zone) const { return zones[zone].name; }
+	Statistics statistics(std::size_t zone) const;
+
+	// frames whose results were thrown away rather than waited for
+	std::size_t droppedFrames() const { return dropped; }
+
+	void report(std::ostream& out) const;
+};
+
+// a GPU zone for the rest of the scope
+class GPUZone
+{
+private:
+	GPUProfiler& profiler;
+	std::size_t zone;
+
+public:
+	GPUZone(const GPUZone&) = delete;
+	GPUZone& operator =(const GPUZone&) = delete;
+
+	GPUZone(GPUProfiler& profiler, std::size_t zone)
+		: profiler(profiler),
+		  zone(zone)
+	{
+		profiler.begin(zone);
+	}
+
+	GPUZone(GPUProfiler& profiler, const std::string& name)
+		: GPUZone(profiler, profiler.zone(name))
+	{
+	}
+
+	~GPUZone()
+	{
+		profiler.end(zone);
+	}
+};
+
+#endif  // INCLUDED_FRAMEWORK_GPU_PROFILER
@@ -0,0 +1,28 @@
+
+
+
+#include <cstring>
+
+#include "hash.h"
+
+
+std::uint64_t hashBytes(const void* data, std::size_t size)
+{
+	const std::uint64_t prime = 0x100000001B3ULL;
+
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	std::uint64_t h = 0xCBF29CE484222325ULL ^ size;
+
+	for (; size >= 8; p += 8, size -= 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, p, 8);
+		h = (h ^ word) * prime;
+		h ^= h >> 29;
+	}
+
+	for (; size > 0; ++p, --size)
+		h = (h ^ *p) * prime;
+
+	return h ^ (h >> 32);
+}
@@ -0,0 +1,16 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_HASH
+#define INCLUDED_FRAMEWORK_HASH
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// 64-bit FNV-1a style hash, consuming eight bytes per step
+std::uint64_t hashBytes(const void* data, std::size_t size);
+
+#endif  // INCLUDED_FRAMEWORK_HASH
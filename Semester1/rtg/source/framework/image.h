@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <algorithm>
 
@@ -84,5 +85,33 @@ public:
 	}
 };
 
+// the next mip level of an RGBA8 image, half the size but at least 1, every texel the mean of the ones it covers
+inline image<std::uint32_t> downsample(const image<std::uint32_t>& img)
+{
+	size_t w = width(img), h = height(img);
+	image<std::uint32_t> level(std::max<size_t>(w / 2, 1), std::max<size_t>(h / 2, 1));
+
+	for (size_t y = 0; y < height(level); ++y)
+		for (size_t x = 0; x < width(level); ++x)
+		{
+			std::uint32_t texels[] = {
+				img(2 * x, 2 * y), img(std::min(2 * x + 1, w - 1), 2 * y),
+				img(2 * x, std::min(2 * y + 1, h - 1)), img(std::min(2 * x + 1, w - 1), std::min(2 * y + 1, h - 1))
+			};
+
+			std::uint32_t texel = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				std::uint32_t sum = 2;
+				for (std::uint32_t t : texels)
+					sum += (t >> shift) & 0xFFU;
+				texel |= (sum / 4) << shift;
+			}
+			level(x, y) = texel;
+		}
+
+	return level;
+}
+
 #endif  // INCLUDED_FRAMEWORK_IMAGE
 
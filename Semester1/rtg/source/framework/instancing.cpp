@@ -0,0 +1,50 @@
+
+
+
+#include "instancing.h"
+
+
+Instance makeInstance(const math::float4x4& model, const math::float4& color)
+{
+	return Instance {
+		math::float3x4(model._11, model._12, model._13, model._14,
+		               model._21, model._22, model._23, model._24,
+		               model._31, model._32, model._33, model._34),
+		color
+	};
+}
+
+InstanceBuffer::InstanceBuffer()
+	: buffer(createBuffer()),
+	  capacity(0),
+	  count(0)
+{
+}
+
+void InstanceBuffer::attach(GLuint first_location) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	InstanceFormat::configure(first_location, 0, 1);
+}
+
+void InstanceBuffer::update(const Instance* instances, std::size_t instance_count)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	if (instance_count > capacity)
+		capacity = instance_count;
+
+	glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, instance_count * sizeof(Instance), instances);
+
+	count = instance_count;
+}
+
+void drawInstanced(const InstanceBuffer& instances, GLsizei index_count, GLenum index_type, std::size_t index_byte_offset)
+{
+	if (instances.size() == 0)
+		return;
+
+	glDrawElementsInstanced(GL_TRIANGLES, index_count, index_type, reinterpret_cast<const void*>(index_byte_offset),
+	                        static_cast<GLsizei>(instances.size()));
+}
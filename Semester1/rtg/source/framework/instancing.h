@@ -0,0 +1,61 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_INSTANCING
+#define INCLUDED_FRAMEWORK_INSTANCING
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+#include "gl_objects.h"
+#include "vertex_format.h"
+
+
+// one copy of a mesh: the upper three rows of its model matrix and the color it is tinted with
+struct Instance
+{
+	math::float3x4 transform;
+	math::float4 color;
+};
+
+typedef vertex_format<attribute::transform<math::float3x4>, attribute::color<math::float4>> InstanceFormat;
+
+static_assert(InstanceFormat::stride == sizeof(Instance), "instance format does not match the instances");
+static_assert(InstanceFormat::offset<1>() == offsetof(Instance, color), "instance format does not match the instances");
+
+Instance makeInstance(const math::float4x4& model, const math::float4& color);
+
+// the instances of a mesh in a buffer of their own, next to the vertex buffer of the mesh; in the
+// shader the transform rows arrive as three vec4 at first_location and the color right after them
+class InstanceBuffer
+{
+private:
+	Buffer buffer;
+	std::size_t capacity;
+	std::size_t count;
+
+public:
+	InstanceBuffer();
+
+	// points the instance attributes of the bound vertex array at this buffer
+	void attach(GLuint first_location) const;
+
+	// replaces the instances; the old storage is orphaned, so frames still drawing them do not block this
+	void update(const Instance* instances, std::size_t count);
+	void update(const std::vector<Instance>& instances) { update(instances.data(), instances.size()); }
+
+	std::size_t size() const { return count; }
+
+	operator GLuint() const { return buffer; }
+};
+
+// one draw call for all instances, with the mesh (or LOD) given by its range in the bound element buffer
+void drawInstanced(const InstanceBuffer& instances, GLsizei index_count, GLenum index_type, std::size_t index_byte_offset);
+
+#endif  // INCLUDED_FRAMEWORK_INSTANCING
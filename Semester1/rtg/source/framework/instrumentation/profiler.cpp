@@ -0,0 +1,249 @@
+
+
+
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <limits>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include "profiler.h"
+
+
+namespace
+{
+	const std::size_t ring_size = 1 << 16;
+
+	// fields are relaxed atomics so that reading a ring while its thread records is not a race,
+	// which costs nothing over plain stores
+	struct Event
+	{
+		std::atomic<const char*> name;
+		std::atomic<std::uint64_t> begin;
+		std::atomic<std::uint64_t> end;
+	};
+
+	struct Ring
+	{
+		std::unique_ptr<Event[]> events;
+		std::atomic<std::uint64_t> head;
+		unsigned int id;
+
+		explicit Ring(unsigned int id)
+			: events(new Event[ring_size]),
+			  head(0),
+			  id(id)
+		{
+		}
+	};
+
+	struct Sample
+	{
+		const char* name;
+		std::uint64_t begin;
+		std::uint64_t end;
+		unsigned int ring;
+	};
+
+	void writeString(std::ostream& out, const char* s)
+	{
+		out << '"';
+		for (; *s; ++s)
+		{
+			if (*s == '"' || *s == '\\')
+				out << '\\' << *s;
+			else if (static_cast<unsigned char>(*s) < 0x20)
+				out << ' ';
+			else
+				out << *s;
+		}
+		out << '"';
+	}
+
+	// rings are handed to threads on their first zone and taken back when they exit, so that the
+	// workers a parallel::run starts anew every time reuse the rings of those before them
+	class Registry
+	{
+	private:
+		std::mutex mutex;
+		std::vector<std::unique_ptr<Ring>> rings;
+		std::vector<Ring*> free_rings;
+
+	public:
+		Registry() = default;
+		Registry(const Registry&) = delete;
+		Registry& operator =(const Registry&) = delete;
+
+		~Registry()
+		{
+			const char* filename = std::getenv("RTG_TRACE");
+			if (!filename || !*filename)
+				return;
+
+			try
+			{
+				write(filename);
+			}
+			catch (std::exception& e)
+			{
+				std::cerr << "error: " << e.what() << std::endl;
+			}
+		}
+
+		Ring* acquire()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (free_rings.empty())
+			{
+				rings.emplace_back(new Ring(static_cast<unsigned int>(rings.size())));
+				return rings.back().get();
+			}
+
+			Ring* ring = free_rings.back();
+			free_rings.pop_back();
+			return ring;
+		}
+
+		void release(Ring* ring)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			free_rings.push_back(ring);
+		}
+
+		// the events of every ring that were not overwritten while reading them
+		std::vector<Sample> collect()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			std::vector<Sample> samples;
+			for (const auto& ring : rings)
+			{
+				std::uint64_t head = ring->head.load(std::memory_order_acquire);
+				std::size_t first = samples.size();
+
+				for (std::uint64_t i = head > ring_size ? head - ring_size : 0; i < head; ++i)
+				{
+					const Event& e = ring->events[i & (ring_size - 1)];
+					samples.push_back(Sample { e.name.load(std::memory_order_relaxed), e.begin.load(std::memory_order_relaxed), e.end.load(std::memory_order_relaxed), ring->id });
+				}
+
+				// event i may have been torn once the thread got to event i + ring_size
+				std::atomic_thread_fence(std::memory_order_acquire);
+				std::uint64_t written = ring->head.load(std::memory_order_relaxed);
+				std::uint64_t valid = written >= ring_size ? written - ring_size + 1 : 0;
+				std::uint64_t read = head > ring_size ? head - ring_size : 0;
+				if (valid > read)
+					samples.erase(samples.begin() + first, samples.begin() + first + static_cast<std::size_t>(std::min(valid - read, head - read)));
+			}
+
+			return samples;
+		}
+
+		unsigned int ringCount()
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return static_cast<unsigned int>(rings.size());
+		}
+
+		void write(std::ostream& out)
+		{
+			std::vector<Sample> samples = collect();
+
+			std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+			for (const Sample& s : samples)
+				origin = std::min(origin, s.begin);
+
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+
+			// a ring outlives its thread, its lane shows every thread that had it
+			unsigned int rings = ringCount();
+			for (unsigned int i = 0; i < rings; ++i)
+				out << (i ? ",\n" : "\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"thread " << i << "\"}}";
+
+			for (const Sample& s : samples)
+			{
+				out << ",\n{\"name\":";
+				writeString(out, s.name);
+				out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << s.ring
+				    << ",\"ts\":" << (s.begin - origin) * 1e-3
+				    << ",\"dur\":" << (s.end - s.begin) * 1e-3 << "}";
+			}
+
+			out << "\n]}" << std::endl;
+		}
+
+		void write(const char* filename)
+		{
+			std::ofstream file(filename);
+			if (!file)
+				throw std::runtime_error(std::string("unable to open '") + filename + "'");
+
+			write(file);
+		}
+	};
+
+	Registry& registry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	struct ThreadRing
+	{
+		Ring* ring = nullptr;
+
+		~ThreadRing()
+		{
+			if (ring)
+				registry().release(ring);
+		}
+	};
+
+	thread_local ThreadRing thread_ring;
+}
+
+namespace profiler
+{
+	std::uint64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void record(const char* name, std::uint64_t begin, std::uint64_t end)
+	{
+		Ring*& ring = thread_ring.ring;
+		if (!ring)
+			ring = registry().acquire();
+
+		std::uint64_t i = ring->head.load(std::memory_order_relaxed);
+
+		// a reader that sees any of the fields below also sees head at i and knows the slot was being written
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Event& e = ring->events[i & (ring_size - 1)];
+		e.name.store(name, std::memory_order_relaxed);
+		e.begin.store(begin, std::memory_order_relaxed);
+		e.end.store(end, std::memory_order_relaxed);
+
+		ring->head.store(i + 1, std::memory_order_release);
+	}
+
+	void writeTrace(std::ostream& out)
+	{
+		registry().write(out);
+	}
+
+	void writeTrace(const char* filename)
+	{
+		registry().write(filename);
+	}
+}
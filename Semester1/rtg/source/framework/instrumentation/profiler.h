@@ -0,0 +1,64 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_INSTRUMENTATION_PROFILER
+#define INCLUDED_FRAMEWORK_INSTRUMENTATION_PROFILER
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+
+
+// CPU time spent in named scopes, for a look at a frame or a load in chrome://tracing or Perfetto.
+// every thread records into a ring of its own without locking, a zone costs two clock reads and one
+// event written when it ends; only the newest events of a thread are kept once its ring is full.
+// the names are not copied, they have to be string literals. the macros are there only when the
+// build has FRAMEWORK_INSTRUMENTATION, which the instrumentation project defines for every
+// configuration but Submission; the trace is written on request, or at exit to the file named
+// by the RTG_TRACE environment variable
+namespace profiler
+{
+	// nanoseconds on the steady clock, i.e. clock_gettime(CLOCK_MONOTONIC) on Linux
+	std::uint64_t now();
+
+	void record(const char* name, std::uint64_t begin, std::uint64_t end);
+
+	// Chrome trace event JSON of what the rings hold, safe while other threads keep recording
+	void writeTrace(std::ostream& out);
+	void writeTrace(const char* filename);
+
+	class Zone
+	{
+	private:
+		const char* name;
+		std::uint64_t begin;
+
+	public:
+		Zone(const Zone&) = delete;
+		Zone& operator =(const Zone&) = delete;
+
+		explicit Zone(const char* name)
+			: name(name),
+			  begin(now())
+		{
+		}
+
+		~Zone()
+		{
+			record(name, begin, now());
+		}
+	};
+}
+
+#ifdef FRAMEWORK_INSTRUMENTATION
+#define PROFILE_CONCAT_(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_(A, B)
+#define PROFILE_ZONE(NAME) profiler::Zone PROFILE_CONCAT(profile_zone_, __LINE__)(NAME)
+#define PROFILE_WRITE_TRACE(FILENAME) profiler::writeTrace(FILENAME)
+#else
+#define PROFILE_ZONE(NAME) ((void)0)
+#define PROFILE_WRITE_TRACE(FILENAME) ((void)0)
+#endif
+
+#endif  // INCLUDED_FRAMEWORK_INSTRUMENTATION_PROFILER
@@ -0,0 +1,164 @@
+
+
+
+#include <string>
+#include <utility>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mapped_file.h"
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* filename, Access access)
+	: m(nullptr),
+	  length(0),
+	  file(INVALID_HANDLE_VALUE),
+	  mapping(nullptr)
+{
+	DWORD hint = access == Access::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | hint, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error(std::string("unable to open '") + filename + "'");
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		close();
+		throw std::runtime_error(std::string("unable to stat '") + filename + "'");
+	}
+
+	length = static_cast<std::size_t>(file_size.QuadPart);
+
+	if (length == 0)
+		return;
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping)
+		m = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (m == nullptr)
+	{
+		close();
+		throw std::runtime_error(std::string("unable to map '") + filename + "'");
+	}
+}
+
+void MappedFile::close()
+{
+	if (m)
+		UnmapViewOfFile(m);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+}
+
+MappedFile::MappedFile(MappedFile&& f)
+	: m(f.m),
+	  length(f.length),
+	  file(f.file),
+	  mapping(f.mapping)
+{
+	f.m = nullptr;
+	f.length = 0;
+	f.file = INVALID_HANDLE_VALUE;
+	f.mapping = nullptr;
+}
+
+MappedFile& MappedFile::operator =(MappedFile&& f)
+{
+	using std::swap;
+	swap(m, f.m);
+	swap(length, f.length);
+	swap(file, f.file);
+	swap(mapping, f.mapping);
+	return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const char* filename, Access access)
+	: m(nullptr),
+	  length(0)
+{
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+		throw std::runtime_error(std::string("unable to open '") + filename + "'");
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error(std::string("unable to stat '") + filename + "'");
+	}
+
+	length = static_cast<std::size_t>(info.st_size);
+
+	if (length != 0)
+	{
+		void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (p == MAP_FAILED)
+		{
+			::close(fd);
+			throw std::runtime_error(std::string("unable to map '") + filename + "'");
+		}
+
+		// the kernel can read ahead aggressively and drop pages behind us
+		if (access == Access::SEQUENTIAL)
+		{
+			madvise(p, length, MADV_SEQUENTIAL);
+			madvise(p, length, MADV_WILLNEED);
+		}
+		else
+			madvise(p, length, MADV_RANDOM);
+
+		m = static_cast<const char*>(p);
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	::close(fd);
+}
+
+void MappedFile::close()
+{
+	if (m)
+		munmap(const_cast<char*>(m), length);
+}
+
+MappedFile::MappedFile(MappedFile&& f)
+	: m(f.m),
+	  length(f.length)
+{
+	f.m = nullptr;
+	f.length = 0;
+}
+
+MappedFile& MappedFile::operator =(MappedFile&& f)
+{
+	using std::swap;
+	swap(m, f.m);
+	swap(length, f.length);
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
@@ -0,0 +1,47 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MAPPED_FILE
+#define INCLUDED_FRAMEWORK_MAPPED_FILE
+
+#pragma once
+
+#include <cstddef>
+
+
+// read-only view of a whole file mapped into memory
+class MappedFile
+{
+private:
+	const char* m;
+	std::size_t length;
+
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#endif
+
+	void close();
+
+public:
+	enum class Access
+	{
+		SEQUENTIAL,
+		RANDOM
+	};
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator =(const MappedFile&) = delete;
+
+	MappedFile(const char* filename, Access access = Access::SEQUENTIAL);
+	MappedFile(MappedFile&& f);
+	~MappedFile();
+
+	MappedFile& operator =(MappedFile&& f);
+
+	const char* begin() const { return m; }
+	const char* end() const { return m + length; }
+	std::size_t size() const { return length; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_MAPPED_FILE
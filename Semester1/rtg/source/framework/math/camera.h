@@ -0,0 +1,46 @@
+
+
+
+#ifndef INCLUDED_MATH_CAMERA
+#define INCLUDED_MATH_CAMERA
+
+#pragma once
+
+#include <cmath>
+
+#include "vector.h"
+#include "matrix.h"
+
+
+namespace math
+{
+	// view matrix of a camera at position looking at target, right-handed with the camera looking down -z
+	inline float4x4 look_at(const float3& position, const float3& target, const float3& up)
+	{
+		float3 w = normalize(position - target);
+		float3 u = normalize(cross(up, w));
+		float3 v = cross(w, u);
+
+		return float4x4(
+			u.x, u.y, u.z, -dot(position, u),
+			v.x, v.y, v.z, -dot(position, v),
+			w.x, w.y, w.z, -dot(position, w),
+			0.0f, 0.0f, 0.0f, 1.0f
+		);
+	}
+
+	// fov is the vertical field of view in radians; maps [-near_plane, -far_plane] to the clip volume -w <= z <= w
+	inline float4x4 perspective(float fov, float aspect, float near_plane, float far_plane)
+	{
+		float f = 1.0f / std::tan(fov * 0.5f);
+
+		return float4x4(
+			f / aspect, 0.0f, 0.0f, 0.0f,
+			0.0f, f, 0.0f, 0.0f,
+			0.0f, 0.0f, -(far_plane + near_plane) / (far_plane - near_plane), -2.0f * far_plane * near_plane / (far_plane - near_plane),
+			0.0f, 0.0f, -1.0f, 0.0f
+		);
+	}
+}
+
+#endif  // INCLUDED_MATH_CAMERA
@@ -0,0 +1,70 @@
+
+
+
+#ifndef INCLUDED_MATH_FRUSTUM
+#define INCLUDED_MATH_FRUSTUM
+
+#pragma once
+
+#include "vector.h"
+#include "matrix.h"
+
+
+namespace math
+{
+	// the planes that bound what a view-projection matrix maps into the clip volume, in the order
+	// left, right, bottom, top, near, far; each one is (n, d) with n of unit length and n.p + d >= 0
+	// on the inside
+	struct frustum
+	{
+		float4 planes[6];
+	};
+
+	// for column vectors (clip = M * p) and a clip volume of -w <= x, y, z <= w
+	inline frustum extract_frustum(const float4x4& M)
+	{
+		float4 row1(M._11, M._12, M._13, M._14);
+		float4 row2(M._21, M._22, M._23, M._24);
+		float4 row3(M._31, M._32, M._33, M._34);
+		float4 row4(M._41, M._42, M._43, M._44);
+
+		frustum f;
+		f.planes[0] = row4 + row1;
+		f.planes[1] = row4 - row1;
+		f.planes[2] = row4 + row2;
+		f.planes[3] = row4 - row2;
+		f.planes[4] = row4 + row3;
+		f.planes[5] = row4 - row3;
+
+		for (float4& p : f.planes)
+			p = p * (1.0f / length(float3(p.x, p.y, p.z)));
+
+		return f;
+	}
+
+	// false only if the sphere is completely outside of one of the planes
+	inline bool intersects(const frustum& f, const float3& center, float radius)
+	{
+		for (const float4& p : f.planes)
+			if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius)
+				return false;
+		return true;
+	}
+
+	// false only if the box is completely outside of one of the planes, tested with the corner
+	// furthest along the plane normal
+	inline bool intersects(const frustum& f, const float3& bbox_min, const float3& bbox_max)
+	{
+		for (const float4& p : f.planes)
+		{
+			float x = p.x > 0.0f ? bbox_max.x : bbox_min.x;
+			float y = p.y > 0.0f ? bbox_max.y : bbox_min.y;
+			float z = p.z > 0.0f ? bbox_max.z : bbox_min.z;
+			if (p.x * x + p.y * y + p.z * z + p.w < 0.0f)
+				return false;
+		}
+		return true;
+	}
+}
+
+#endif  // INCLUDED_MATH_FRUSTUM
@@ -0,0 +1,160 @@
+
+
+
+#include <cstring>
+#include <algorithm>
+
+#include "mesh.h"
+
+
+namespace
+{
+	struct CornerKey
+	{
+		std::int32_t v, vt, vn;
+
+		bool operator ==(const CornerKey& k) const
+		{
+			return v == k.v && vt == k.vt && vn == k.vn;
+		}
+	};
+
+	inline std::uint32_t hash(const CornerKey& k)
+	{
+		std::uint32_t h = static_cast<std::uint32_t>(k.v) * 0x9E3779B1U;
+		h ^= static_cast<std::uint32_t>(k.vt) * 0x85EBCA77U;
+		h = (h << 13) | (h >> 19);
+		h ^= static_cast<std::uint32_t>(k.vn) * 0xC2B2AE3DU;
+		return h ^ (h >> 16);
+	}
+
+	const std::uint32_t empty_slot = 0xFFFFFFFFU;
+
+	// open addressing with linear probing, kept below 50% load
+	class CornerTable
+	{
+	private:
+		std::vector<CornerKey> keys;
+		std::vector<std::uint32_t> values;
+		std::uint32_t mask;
+
+	public:
+		CornerTable(std::size_t max_entries)
+		{
+			std::size_t size = 16;
+			while (size < max_entries * 2)
+				size *= 2;
+			keys.resize(size);
+			values.assign(size, empty_slot);
+			mask = static_cast<std::uint32_t>(size - 1);
+		}
+
+		// returns the value already stored for key, or stores and returns the given one
+		std::uint32_t insert(const CornerKey& key, std::uint32_t value)
+		{
+			for (std::uint32_t i = hash(key) & mask;; i = (i + 1) & mask)
+			{
+				if (values[i] == empty_slot)
+				{
+					keys[i] = key;
+					values[i] = value;
+					return value;
+				}
+				if (keys[i] == key)
+					return values[i];
+			}
+		}
+	};
+
+	std::vector<math::float3> smoothNormals(const OBJ::Mesh& mesh)
+	{
+		std::vector<math::float3> normals(mesh.positionCount(), math::float3(0.0f));
+
+		for (std::size_t i = 0; i < mesh.position_indices.size(); i += 3)
+		{
+			math::float3 p0 = mesh.position(mesh.position_indices[i]);
+			math::float3 p1 = mesh.position(mesh.position_indices[i + 1]);
+			math::float3 p2 = mesh.position(mesh.position_indices[i + 2]);
+
+			// not normalized, larger faces weigh more
+			math::float3 n = cross(p1 - p0, p2 - p0);
+
+			for (std::size_t j = i; j < i + 3; ++j)
+				if (mesh.normal_indices[j] < 0)
+					normals[mesh.position_indices[j]] += n;
+		}
+
+		for (auto&& n : normals)
+		{
+			float l = length(n);
+			if (l > 0.0f)
+				n = n * (1.0f / l);
+		}
+
+		return normals;
+	}
+}
+
+std::vector<std::uint8_t> packIndices(const std::vector<std::uint32_t>& indices, std::size_t index_size)
+{
+	std::vector<std::uint8_t> data(indices.size() * index_size);
+
+	if (indices.empty())
+		return data;
+
+	if (index_size == 2)
+		std::copy(indices.begin(), indices.end(), reinterpret_cast<std::uint16_t*>(&data[0]));
+	else
+		std::memcpy(&data[0], &indices[0], data.size());
+
+	return data;
+}
+
+std::vector<std::uint8_t> IndexedMesh::packIndices() const
+{
+	return ::packIndices(indices, indexSize());
+}
+
+IndexedMesh buildIndexedMesh(const OBJ::Mesh& mesh, bool flip_v)
+{
+	std::size_t corners = mesh.position_indices.size();
+
+	std::vector<math::float3> smooth_normals;
+	if (std::find(mesh.normal_indices.begin(), mesh.normal_indices.end(), -1) != mesh.normal_indices.end())
+		smooth_normals = smoothNormals(mesh);
+
+	IndexedMesh result;
+	result.indices.resize(corners);
+
+	CornerTable table(corners);
+
+	for (std::size_t i = 0; i < corners; ++i)
+	{
+		CornerKey key = { mesh.position_indices[i], mesh.texcoord_indices[i], mesh.normal_indices[i] };
+
+		std::uint32_t next = static_cast<std::uint32_t>(result.vertices.size());
+		std::uint32_t index = table.insert(key, next);
+
+		if (index == next)
+		{
+			Vertex vertex;
+			vertex.position = mesh.position(key.v);
+			vertex.normal = key.vn < 0 ? smooth_normals[key.v] : mesh.normal(key.vn);
+			vertex.texcoord = key.vt < 0 ? math::float2(0.0f, 0.0f) : mesh.texcoord(key.vt);
+			if (flip_v)
+				vertex.texcoord.y = 1.0f - vertex.texcoord.y;
+			result.vertices.push_back(vertex);
+		}
+
+		result.indices[i] = index;
+	}
+
+	result.bbox_min = result.bbox_max = result.vertices.empty() ? math::float3(0.0f) : result.vertices[0].position;
+	for (auto&& v : result.vertices)
+	{
+		result.bbox_min = min(result.bbox_min, v.position);
+		result.bbox_max = max(result.bbox_max, v.position);
+	}
+
+	return result;
+}
@@ -0,0 +1,48 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH
+#define INCLUDED_FRAMEWORK_MESH
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+#include "obj.h"
+
+
+struct Vertex
+{
+	math::float3 position;
+	math::float3 normal;
+	math::float2 texcoord;
+};
+
+struct IndexedMesh
+{
+	std::vector<Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+
+	math::float3 bbox_min;
+	math::float3 bbox_max;
+
+	std::size_t triangleCount() const { return indices.size() / 3; }
+
+	// 16-bit indices are used whenever every vertex can be addressed with them
+	std::size_t indexSize() const { return vertices.size() <= 0x10000U ? 2U : 4U; }
+
+	// the index buffer in indexSize() bytes per index, ready to be uploaded
+	std::vector<std::uint8_t> packIndices() const;
+};
+
+// indices in index_size (2 or 4) bytes each
+std::vector<std::uint8_t> packIndices(const std::vector<std::uint32_t>& indices, std::size_t index_size);
+
+// merges face corners with identical position/texcoord/normal triplets into one vertex;
+// positions without a normal in the file get the area-weighted average of their face normals
+IndexedMesh buildIndexedMesh(const OBJ::Mesh& mesh, bool flip_v = false);
+
+#endif  // INCLUDED_FRAMEWORK_MESH
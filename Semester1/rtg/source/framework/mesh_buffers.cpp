@@ -0,0 +1,20 @@
+
+
+
+#include "geometry_pool.h"
+#include "mesh_buffers.h"
+
+
+MeshBuffers::MeshBuffers(const CachedMesh& mesh)
+	: vao(createVertexArray()),
+	  index_type(mesh.indexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT),
+	  index_count(static_cast<GLsizei>(mesh.lod(0).index_count)),
+	  bbox_min(mesh.bboxMin()),
+	  bbox_max(mesh.bboxMax())
+{
+	glBindVertexArray(vao);
+	vertices = createBuffer(GL_ARRAY_BUFFER, MeshVertexFormat::stride * mesh.vertexCount(), mesh.vertices());
+	MeshVertexFormat::configure();
+	indices = createBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexSize() * mesh.indexCount(), mesh.indices());
+	glBindVertexArray(0);
+}
@@ -0,0 +1,31 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_BUFFERS
+#define INCLUDED_FRAMEWORK_MESH_BUFFERS
+
+#pragma once
+
+#include <GL/gl.h>
+
+#include "math/vector.h"
+#include "mesh_cache.h"
+#include "gl_objects.h"
+
+
+// a mesh in buffers of its own behind a vertex array of its own, the way meshes are drawn without a
+// GeometryPool; index_count covers the full LOD
+struct MeshBuffers
+{
+	VertexArray vao;
+	Buffer vertices;
+	Buffer indices;
+	GLenum index_type;
+	GLsizei index_count;
+	math::float3 bbox_min;
+	math::float3 bbox_max;
+
+	explicit MeshBuffers(const CachedMesh& mesh);
+};
+
+#endif  // INCLUDED_FRAMEWORK_MESH_BUFFERS
@@ -0,0 +1,221 @@
+
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "instrumentation/profiler.h"
+#include "hash.h"
+#include "obj.h"
+#include "mesh_optimize.h"
+#include "mesh_cache.h"
+
+
+namespace
+{
+	const char magic[4] = { 'R', 'T', 'G', 'M' };
+
+	// bump whenever the layout of the file or the way meshes are built changes
+	const std::uint32_t cache_version = 3;
+
+	const std::uint32_t FLIP_V = 0x1U;
+
+	static_assert(sizeof(MeshCacheHeader) == 80, "mesh cache header must not contain padding");
+	static_assert(sizeof(Vertex) == 32, "mesh cache vertices must be tightly packed");
+	static_assert(sizeof(MeshLod) == 12, "mesh cache LOD table must be tightly packed");
+
+	struct SourceInfo
+	{
+		bool exists;
+		std::uint64_t size;
+		std::int64_t mtime;
+	};
+
+	SourceInfo statSource(const char* filename)
+	{
+#ifdef _WIN32
+		struct __stat64 info;
+		if (_stat64(filename, &info) != 0)
+			return SourceInfo { false, 0, 0 };
+#else
+		struct stat info;
+		if (stat(filename, &info) != 0)
+			return SourceInfo { false, 0, 0 };
+#endif
+		return SourceInfo { true, static_cast<std::uint64_t>(info.st_size), static_cast<std::int64_t>(info.st_mtime) };
+	}
+
+	std::uint64_t hashFile(const char* filename)
+	{
+		MappedFile file(filename);
+		return hashBytes(file.begin(), file.size());
+	}
+
+	// returns nullptr unless the mapped file is a complete cache of the current version
+	const MeshCacheHeader* validHeader(const MappedFile& file, std::uint32_t flags)
+	{
+		if (file.size() < sizeof(MeshCacheHeader))
+			return nullptr;
+
+		const MeshCacheHeader* header = reinterpret_cast<const MeshCacheHeader*>(file.begin());
+
+		if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != cache_version ||
+		    header->flags != flags || header->vertex_size != sizeof(Vertex) ||
+		    (header->index_size != 2 && header->index_size != 4) || header->lod_count == 0)
+			return nullptr;
+
+		std::uint64_t expected = sizeof(MeshCacheHeader) +
+		                         static_cast<std::uint64_t>(header->lod_count) * sizeof(MeshLod) +
+		                         static_cast<std::uint64_t>(header->vertex_count) * header->vertex_size +
+		                         static_cast<std::uint64_t>(header->index_count) * header->index_size;
+
+		return file.size() == expected ? header : nullptr;
+	}
+
+	std::vector<char> buildBlob(const char* obj_filename, std::uint32_t flags, const SourceInfo& source)
+	{
+		IndexedMesh mesh = buildIndexedMesh(OBJ::loadMesh(obj_filename), (flags & FLIP_V) != 0);
+		optimizeMesh(mesh);
+
+		LodChain chain = buildLodChain(mesh);
+		std::vector<std::uint8_t> indices = packIndices(chain.indices, mesh.indexSize());
+
+		MeshCacheHeader header;
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = cache_version;
+		header.flags = flags;
+		header.vertex_size = sizeof(Vertex);
+		header.source_size = source.size;
+		header.source_mtime = source.mtime;
+		header.source_hash = hashFile(obj_filename);
+		header.vertex_count = static_cast<std::uint32_t>(mesh.vertices.size());
+		header.index_count = static_cast<std::uint32_t>(chain.indices.size());
+		header.index_size = static_cast<std::uint32_t>(mesh.indexSize());
+		header.bbox_min[0] = mesh.bbox_min.x; header.bbox_min[1] = mesh.bbox_min.y; header.bbox_min[2] = mesh.bbox_min.z;
+		header.bbox_max[0] = mesh.bbox_max.x; header.bbox_max[1] = mesh.bbox_max.y; header.bbox_max[2] = mesh.bbox_max.z;
+		header.lod_count = static_cast<std::uint32_t>(chain.lods.size());
+
+		std::size_t lod_bytes = chain.lods.size() * sizeof(MeshLod);
+		std::size_t vertex_bytes = mesh.vertices.size() * sizeof(Vertex);
+
+		std::vector<char> blob(sizeof(MeshCacheHeader) + lod_bytes + vertex_bytes + indices.size());
+		char* p = &blob[0];
+		std::memcpy(p, &header, sizeof(header));
+		p += sizeof(header);
+		std::memcpy(p, &chain.lods[0], lod_bytes);
+		p += lod_bytes;
+		if (vertex_bytes)
+			std::memcpy(p, &mesh.vertices[0], vertex_bytes);
+		p += vertex_bytes;
+		if (!indices.empty())
+			std::memcpy(p, &indices[0], indices.size());
+
+		return blob;
+	}
+
+	// writes to a temporary file first so that a concurrent reader never maps a half written cache
+	bool writeBlob(const std::string& filename, const char* data, std::size_t size)
+	{
+		std::string temporary = filename + ".tmp";
+
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return false;
+			file.write(data, static_cast<std::streamsize>(size));
+			if (!file)
+			{
+				file.close();
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+
+#ifdef _WIN32
+		// rename does not replace existing files on Windows
+		std::remove(filename.c_str());
+#endif
+		if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+		{
+			std::remove(temporary.c_str());
+			return false;
+		}
+
+		return true;
+	}
+}
+
+CachedMesh::CachedMesh(std::unique_ptr<MappedFile> file)
+	: file(std::move(file)),
+	  header(reinterpret_cast<const MeshCacheHeader*>(this->file->begin()))
+{
+}
+
+CachedMesh::CachedMesh(std::vector<char> blob)
+	: blob(std::move(blob)),
+	  header(reinterpret_cast<const MeshCacheHeader*>(&this->blob[0]))
+{
+}
+
+std::string meshCacheFilename(const char* obj_filename)
+{
+	return std::string(obj_filename) + ".mesh";
+}
+
+CachedMesh loadCachedMesh(const char* obj_filename, bool flip_v)
+{
+	PROFILE_ZONE("mesh cache load");
+
+	std::uint32_t flags = flip_v ? FLIP_V : 0U;
+
+	std::string cache_filename = meshCacheFilename(obj_filename);
+	SourceInfo source = statSource(obj_filename);
+
+	std::unique_ptr<MappedFile> cache;
+	try
+	{
+		cache.reset(new MappedFile(cache_filename.c_str(), MappedFile::Access::SEQUENTIAL));
+	}
+	catch (std::runtime_error&)
+	{
+	}
+
+	const MeshCacheHeader* header = cache ? validHeader(*cache, flags) : nullptr;
+
+	if (header)
+	{
+		// a cache without its source is still good enough, e.g. in a stripped down submission
+		if (!source.exists || (header->source_size == source.size && header->source_mtime == source.mtime))
+			return CachedMesh(std::move(cache));
+
+		// the file was touched or copied but not modified, refresh the timestamp so we do not hash again
+		if (header->source_size == source.size && header->source_hash == hashFile(obj_filename))
+		{
+			std::vector<char> blob(cache->begin(), cache->end());
+			reinterpret_cast<MeshCacheHeader*>(&blob[0])->source_mtime = source.mtime;
+
+			cache.reset();
+			if (writeBlob(cache_filename, &blob[0], blob.size()))
+				return CachedMesh(std::unique_ptr<MappedFile>(new MappedFile(cache_filename.c_str())));
+			return CachedMesh(std::move(blob));
+		}
+	}
+
+	if (!source.exists)
+		throw std::runtime_error(std::string("unable to open '") + obj_filename + "'");
+
+	cache.reset();
+
+	std::vector<char> blob = buildBlob(obj_filename, flags, source);
+
+	// a read-only asset directory only costs us the cache, not the mesh
+	writeBlob(cache_filename, &blob[0], blob.size());
+
+	return CachedMesh(std::move(blob));
+}
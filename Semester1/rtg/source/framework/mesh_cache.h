@@ -0,0 +1,81 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_CACHE
+#define INCLUDED_FRAMEWORK_MESH_CACHE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "mapped_file.h"
+#include "mesh.h"
+#include "mesh_lod.h"
+
+
+// binary mesh file written next to an OBJ asset (<asset>.mesh); it holds the GPU-ready vertex buffer
+// of the indexed and cache optimized mesh, the index buffers of all its LODs one after the other and
+// identifies the source it was built from; the LOD table follows the header
+struct MeshCacheHeader
+{
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t flags;
+	std::uint32_t vertex_size;
+	std::uint64_t source_size;
+	std::int64_t source_mtime;
+	std::uint64_t source_hash;
+	std::uint32_t vertex_count;
+	std::uint32_t index_count;  // all LODs
+	std::uint32_t index_size;
+	float bbox_min[3];
+	float bbox_max[3];
+	std::uint32_t lod_count;
+};
+
+class CachedMesh
+{
+private:
+	std::unique_ptr<MappedFile> file;
+	std::vector<char> blob;
+	const MeshCacheHeader* header;
+
+public:
+	CachedMesh(const CachedMesh&) = delete;
+	CachedMesh& operator =(const CachedMesh&) = delete;
+
+	CachedMesh(std::unique_ptr<MappedFile> file);
+	CachedMesh(std::vector<char> blob);
+	CachedMesh(CachedMesh&& m) = default;
+
+	const MeshLod* lods() const { return reinterpret_cast<const MeshLod*>(header + 1); }
+	std::size_t lodCount() const { return header->lod_count; }
+	const MeshLod& lod(std::size_t i) const { return lods()[i]; }
+
+	const Vertex* vertices() const { return reinterpret_cast<const Vertex*>(lods() + header->lod_count); }
+	std::size_t vertexCount() const { return header->vertex_count; }
+
+	// the index buffers of all LODs, lod(i) tells where each one starts
+	const void* indices() const { return vertices() + header->vertex_count; }
+	std::size_t indexCount() const { return header->index_count; }
+	std::size_t indexSize() const { return header->index_size; }
+
+	math::float3 bboxMin() const { return math::float3(header->bbox_min[0], header->bbox_min[1], header->bbox_min[2]); }
+	math::float3 bboxMax() const { return math::float3(header->bbox_max[0], header->bbox_max[1], header->bbox_max[2]); }
+
+	// true if the data is served straight from the mapped cache file rather than a freshly built copy
+	bool mapped() const { return static_cast<bool>(file); }
+};
+
+std::string meshCacheFilename(const char* obj_filename);
+
+// maps the cache of the given OBJ file, or rebuilds it if it is missing or does not match the source
+// any more (size and mtime first, content hash if only the mtime differs); if the cache cannot be
+// written the freshly built mesh is returned from memory
+CachedMesh loadCachedMesh(const char* obj_filename, bool flip_v = false);
+
+#endif  // INCLUDED_FRAMEWORK_MESH_CACHE
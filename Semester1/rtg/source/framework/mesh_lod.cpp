@@ -0,0 +1,81 @@
+
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "mesh_lod.h"
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+
+
+LodChain buildLodChain(const IndexedMesh& mesh, std::size_t max_lods, float reduction, std::size_t min_triangles, float max_error)
+{
+	LodChain chain;
+	chain.indices = mesh.indices;
+	chain.lods.push_back(MeshLod { 0, static_cast<std::uint32_t>(mesh.indices.size()), 0.0f });
+
+	float diagonal = length(mesh.bbox_max - mesh.bbox_min);
+
+	std::size_t previous = mesh.indices.size();
+
+	while (chain.lods.size() < max_lods && previous / 3 > min_triangles)
+	{
+		std::size_t target = static_cast<std::size_t>(previous / 3 * reduction) * 3;
+
+		// always from the full mesh, so the reported error is against the original surface
+		float error = 0.0f;
+		std::vector<std::uint32_t> lod = simplifyMesh(mesh.vertices, mesh.indices, target, max_error * diagonal, &error);
+
+		// not worth another level
+		if (lod.empty() || lod.size() > previous - previous / 10)
+			break;
+
+		optimizeVertexCache(lod, mesh.vertices.size());
+
+		chain.lods.push_back(MeshLod { static_cast<std::uint32_t>(chain.indices.size()), static_cast<std::uint32_t>(lod.size()), error });
+		chain.indices.insert(chain.indices.end(), lod.begin(), lod.end());
+
+		previous = lod.size();
+	}
+
+	return chain;
+}
+
+float pixelsPerUnit(float object_scale, float distance, float vertical_fov, int viewport_height)
+{
+	if (distance <= 0.0f)
+		return 1e30f;
+	return object_scale * viewport_height / (2.0f * std::tan(vertical_fov * 0.5f) * distance);
+}
+
+LodSelector::LodSelector(float hysteresis)
+	: current(0),
+	  hysteresis(hysteresis)
+{
+}
+
+std::size_t LodSelector::select(const MeshLod* lods, std::size_t count, float pixels_per_unit, float threshold_pixels)
+{
+	if (count == 0)
+		return current = 0;
+
+	current = std::min(current, count - 1);
+
+	auto coarsest = [&](float threshold)
+	{
+		std::size_t lod = 0;
+		for (std::size_t i = 1; i < count; ++i)
+			if (lods[i].error * pixels_per_unit <= threshold)
+				lod = i;
+		return lod;
+	};
+
+	// too coarse for the current view, refine right away to what the threshold allows
+	if (lods[current].error * pixels_per_unit > threshold_pixels * (1.0f + hysteresis))
+		current = coarsest(threshold_pixels);
+	else
+		current = std::max(current, coarsest(threshold_pixels * (1.0f - hysteresis)));
+
+	return current;
+}
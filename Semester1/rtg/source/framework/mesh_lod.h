@@ -0,0 +1,53 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_LOD
+#define INCLUDED_FRAMEWORK_MESH_LOD
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.h"
+
+
+struct MeshLod
+{
+	std::uint32_t index_offset;  // first index of the LOD in the shared index buffer
+	std::uint32_t index_count;
+	float error;                 // largest deviation from the full mesh, in mesh units
+};
+
+// successively simplified index buffers over one vertex buffer, LOD 0 is the full mesh
+struct LodChain
+{
+	std::vector<std::uint32_t> indices;
+	std::vector<MeshLod> lods;
+};
+
+// every LOD keeps about reduction of the triangles of the previous one; the chain ends at max_lods,
+// at min_triangles, or when the simplifier cannot get further below max_error (relative to the bounds)
+LodChain buildLodChain(const IndexedMesh& mesh, std::size_t max_lods = 6, float reduction = 0.5f,
+                       std::size_t min_triangles = 64, float max_error = 0.05f);
+
+// pixels covered by one mesh unit at the given view distance
+float pixelsPerUnit(float object_scale, float distance, float vertical_fov, int viewport_height);
+
+// picks the coarsest LOD whose error projects to at most threshold pixels; a LOD change needs the
+// error to clear the threshold by the hysteresis fraction, so LODs do not flicker at the boundary
+class LodSelector
+{
+private:
+	std::size_t current;
+	float hysteresis;
+
+public:
+	LodSelector(float hysteresis = 0.25f);
+
+	std::size_t select(const MeshLod* lods, std::size_t count, float pixels_per_unit, float threshold_pixels = 1.0f);
+	std::size_t lod() const { return current; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_MESH_LOD
@@ -0,0 +1,209 @@
+
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "mesh_optimize.h"
+
+
+namespace
+{
+	// parameters from the paper, tuned for an LRU cache of 32 entries
+	const int cache_size = 32;
+	const float cache_decay_power = 1.5f;
+	const float last_triangle_score = 0.75f;
+	const float valence_boost_scale = 2.0f;
+	const float valence_boost_power = 0.5f;
+	const int max_valence_score = 64;
+
+	class ScoreTable
+	{
+	private:
+		float cache[cache_size];
+		float valence[max_valence_score];
+
+	public:
+		ScoreTable()
+		{
+			for (int i = 0; i < cache_size; ++i)
+			{
+				if (i < 3)
+					// the vertices of the triangle just drawn, using them right away barely helps
+					cache[i] = last_triangle_score;
+				else
+					cache[i] = std::pow(1.0f - static_cast<float>(i - 3) / (cache_size - 3), cache_decay_power);
+			}
+
+			for (int i = 0; i < max_valence_score; ++i)
+				valence[i] = i == 0 ? 0.0f : valence_boost_scale * std::pow(static_cast<float>(i), -valence_boost_power);
+		}
+
+		// vertices with few triangles left get a boost so that no lonely triangles are left behind
+		float operator ()(int cache_position, int live_triangles) const
+		{
+			if (live_triangles == 0)
+				return -1.0f;
+
+			float score = cache_position < 0 ? 0.0f : cache[cache_position];
+			return score + (live_triangles < max_valence_score ? valence[live_triangles] : valence[max_valence_score - 1]);
+		}
+	};
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<std::uint32_t>& indices, std::size_t vertex_count, unsigned int cache_size)
+{
+	// a vertex is in the cache if it was pushed less than cache_size misses ago
+	std::vector<std::size_t> timestamps(vertex_count, 0);
+	std::size_t misses = 0;
+
+	for (std::uint32_t i : indices)
+	{
+		if (timestamps[i] == 0 || misses + 1 - timestamps[i] > cache_size)
+		{
+			++misses;
+			timestamps[i] = misses;
+		}
+	}
+
+	VertexCacheStats stats = { 0.0, 0.0 };
+	if (!indices.empty())
+		stats.acmr = static_cast<double>(misses) / (indices.size() / 3);
+	if (vertex_count)
+		stats.atvr = static_cast<double>(misses) / vertex_count;
+	return stats;
+}
+
+void optimizeVertexCache(std::vector<std::uint32_t>& indices, std::size_t vertex_count)
+{
+	std::size_t triangle_count = indices.size() / 3;
+
+	if (triangle_count == 0)
+		return;
+
+	static const ScoreTable score;
+
+	// triangles adjacent to each vertex, the first live_triangles[v] entries are not emitted yet
+	std::vector<int> live_triangles(vertex_count, 0);
+	for (std::uint32_t i : indices)
+		++live_triangles[i];
+
+	std::vector<std::size_t> adjacency_offset(vertex_count + 1, 0);
+	for (std::size_t v = 0; v < vertex_count; ++v)
+		adjacency_offset[v + 1] = adjacency_offset[v] + live_triangles[v];
+
+	std::vector<std::uint32_t> adjacency(indices.size());
+	{
+		std::vector<std::size_t> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+		for (std::size_t i = 0; i < indices.size(); ++i)
+			adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+	}
+
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (std::size_t v = 0; v < vertex_count; ++v)
+		vertex_score[v] = score(-1, live_triangles[v]);
+
+	std::vector<bool> emitted(triangle_count, false);
+
+	std::vector<std::uint32_t> result;
+	result.reserve(indices.size());
+
+	// three extra slots hold the vertices pushed out while adding a triangle
+	std::vector<std::uint32_t> cache, next_cache;
+	cache.reserve(cache_size + 3);
+	next_cache.reserve(cache_size + 3);
+
+	std::size_t best = 0;
+	std::size_t scan = 0;
+
+	while (result.size() < indices.size())
+	{
+		const std::uint32_t* tri = &indices[3 * best];
+
+		emitted[best] = true;
+		result.insert(result.end(), tri, tri + 3);
+
+		next_cache.assign(tri, tri + 3);
+
+		for (int k = 0; k < 3; ++k)
+		{
+			std::uint32_t v = tri[k];
+
+			// swap the triangle out of the live part of the adjacency list
+			std::uint32_t* begin = &adjacency[adjacency_offset[v]];
+			std::uint32_t* end = begin + live_triangles[v];
+			std::swap(*std::find(begin, end, static_cast<std::uint32_t>(best)), *(end - 1));
+			--live_triangles[v];
+		}
+
+		for (std::uint32_t v : cache)
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				next_cache.push_back(v);
+
+		for (std::size_t i = 0; i < next_cache.size(); ++i)
+		{
+			std::uint32_t v = next_cache[i];
+			cache_position[v] = i < static_cast<std::size_t>(cache_size) ? static_cast<int>(i) : -1;
+			vertex_score[v] = score(cache_position[v], live_triangles[v]);
+		}
+
+		// only triangles touching the cache change their score
+		float best_score = -1.0f;
+		for (std::uint32_t v : next_cache)
+		{
+			for (std::size_t j = adjacency_offset[v], end = adjacency_offset[v] + live_triangles[v]; j < end; ++j)
+			{
+				std::uint32_t t = adjacency[j];
+				float s = vertex_score[indices[3 * t]] + vertex_score[indices[3 * t + 1]] + vertex_score[indices[3 * t + 2]];
+				if (s > best_score)
+				{
+					best_score = s;
+					best = t;
+				}
+			}
+		}
+
+		if (next_cache.size() > static_cast<std::size_t>(cache_size))
+			next_cache.resize(cache_size);
+		std::swap(cache, next_cache);
+
+		// nothing in the cache has work left, continue with the next triangle in the original order
+		if (best_score < 0.0f)
+		{
+			while (scan < triangle_count && emitted[scan])
+				++scan;
+			best = scan;
+		}
+	}
+
+	indices.swap(result);
+}
+
+void optimizeVertexFetch(IndexedMesh& mesh)
+{
+	const std::uint32_t unused = 0xFFFFFFFFU;
+
+	std::vector<std::uint32_t> remap(mesh.vertices.size(), unused);
+	std::vector<Vertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (auto&& i : mesh.indices)
+	{
+		if (remap[i] == unused)
+		{
+			remap[i] = static_cast<std::uint32_t>(vertices.size());
+			vertices.push_back(mesh.vertices[i]);
+		}
+		i = remap[i];
+	}
+
+	// vertices no triangle refers to are dropped
+	mesh.vertices.swap(vertices);
+}
+
+void optimizeMesh(IndexedMesh& mesh)
+{
+	optimizeVertexCache(mesh.indices, mesh.vertices.size());
+	optimizeVertexFetch(mesh);
+}
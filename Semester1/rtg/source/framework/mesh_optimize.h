@@ -0,0 +1,34 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_OPTIMIZE
+#define INCLUDED_FRAMEWORK_MESH_OPTIMIZE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.h"
+
+
+struct VertexCacheStats
+{
+	double acmr;  // transformed vertices per triangle, 0.5 at best for regular grids, 3 at worst
+	double atvr;  // transformed vertices per unique vertex, 1 at best
+};
+
+// simulates a FIFO post-transform cache of the given size over a triangle list
+VertexCacheStats analyzeVertexCache(const std::vector<std::uint32_t>& indices, std::size_t vertex_count, unsigned int cache_size = 16);
+
+// reorders triangles for post-transform cache reuse (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+void optimizeVertexCache(std::vector<std::uint32_t>& indices, std::size_t vertex_count);
+
+// renumbers vertices in order of first use so that vertex fetch walks the buffer front to back
+void optimizeVertexFetch(IndexedMesh& mesh);
+
+// both of the above, in the order that makes sense
+void optimizeMesh(IndexedMesh& mesh);
+
+#endif  // INCLUDED_FRAMEWORK_MESH_OPTIMIZE
@@ -0,0 +1,184 @@
+
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "mesh_quantize.h"
+
+
+namespace
+{
+	const float unorm16_max = 65535.0f;
+	const float snorm16_max = 32767.0f;
+
+	inline std::uint16_t quantizeUnorm16(float v, float offset, float scale)
+	{
+		if (scale <= 0.0f)
+			return 0;
+		float q = (v - offset) / scale;
+		return static_cast<std::uint16_t>(std::min(std::max(q + 0.5f, 0.0f), unorm16_max));
+	}
+
+	inline short quantizeSnorm16(float v)
+	{
+		float q = std::min(std::max(v, -1.0f), 1.0f) * snorm16_max;
+		return static_cast<short>(q < 0.0f ? q - 0.5f : q + 0.5f);
+	}
+
+	inline float signNotZero(float v)
+	{
+		return v < 0.0f ? -1.0f : 1.0f;
+	}
+
+	// the scale that maps [0, 65535] onto [min, max]
+	inline float unorm16Scale(float min, float max)
+	{
+		return (max - min) / unorm16_max;
+	}
+
+	// atan2 stays accurate for tiny angles where acos of the dot product does not
+	float angleDegrees(const math::float3& a, const math::float3& b)
+	{
+		return std::atan2(length(cross(a, b)), dot(a, b)) * 180.0f / 3.14159265358979f;
+	}
+}
+
+math::float3 QuantizedMesh::position(const QuantizedVertex& v) const
+{
+	return math::float3(position_offset.x + v.position.x * position_scale.x,
+	                    position_offset.y + v.position.y * position_scale.y,
+	                    position_offset.z + v.position.z * position_scale.z);
+}
+
+math::float3 QuantizedMesh::normal(const QuantizedVertex& v) const
+{
+	return decodeOctahedral(v.normal);
+}
+
+math::float2 QuantizedMesh::texcoord(const QuantizedVertex& v) const
+{
+	return math::float2(texcoord_offset.x + v.texcoord.x * texcoord_scale.x,
+	                    texcoord_offset.y + v.texcoord.y * texcoord_scale.y);
+}
+
+math::short2 encodeOctahedral(const math::float3& n)
+{
+	float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+	if (l1 == 0.0f)
+		return math::short2(0, 0);
+
+	// project onto the octahedron, fold the lower half over the diagonals
+	float x = n.x / l1, y = n.y / l1;
+	if (n.z < 0.0f)
+	{
+		float fx = (1.0f - std::abs(y)) * signNotZero(x);
+		float fy = (1.0f - std::abs(x)) * signNotZero(y);
+		x = fx;
+		y = fy;
+	}
+
+	// rounding each component on its own is not always closest, try the neighbouring codes too
+	math::short2 best(quantizeSnorm16(x), quantizeSnorm16(y));
+	math::float3 target = normalize(n);
+	float best_error = 5.0f;
+
+	short base_x = static_cast<short>(std::floor(std::min(std::max(x, -1.0f), 1.0f) * snorm16_max));
+	short base_y = static_cast<short>(std::floor(std::min(std::max(y, -1.0f), 1.0f) * snorm16_max));
+
+	for (int dx = 0; dx <= 1; ++dx)
+		for (int dy = 0; dy <= 1; ++dy)
+		{
+			int cx = std::min(base_x + dx, 32767), cy = std::min(base_y + dy, 32767);
+			math::short2 candidate(static_cast<short>(cx), static_cast<short>(cy));
+			math::float3 d = decodeOctahedral(candidate) - target;
+			float error = dot(d, d);
+			if (error < best_error)
+			{
+				best_error = error;
+				best = candidate;
+			}
+		}
+
+	return best;
+}
+
+math::float3 decodeOctahedral(const math::short2& e)
+{
+	math::float3 n(std::max(e.x / snorm16_max, -1.0f), std::max(e.y / snorm16_max, -1.0f), 0.0f);
+	n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+
+	// unfold the lower half
+	float t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+
+	return normalize(n);
+}
+
+QuantizedMesh quantizeVertices(const Vertex* vertices, std::size_t count)
+{
+	QuantizedMesh mesh;
+
+	math::float3 position_min(0.0f), position_max(0.0f);
+	math::float2 texcoord_min(0.0f, 0.0f), texcoord_max(0.0f, 0.0f);
+
+	if (count)
+	{
+		position_min = position_max = vertices[0].position;
+		texcoord_min = texcoord_max = vertices[0].texcoord;
+	}
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		position_min = min(position_min, vertices[i].position);
+		position_max = max(position_max, vertices[i].position);
+		texcoord_min = min(texcoord_min, vertices[i].texcoord);
+		texcoord_max = max(texcoord_max, vertices[i].texcoord);
+	}
+
+	mesh.position_offset = position_min;
+	mesh.position_scale = math::float3(unorm16Scale(position_min.x, position_max.x),
+	                                   unorm16Scale(position_min.y, position_max.y),
+	                                   unorm16Scale(position_min.z, position_max.z));
+	mesh.texcoord_offset = texcoord_min;
+	mesh.texcoord_scale = math::float2(unorm16Scale(texcoord_min.x, texcoord_max.x),
+	                                   unorm16Scale(texcoord_min.y, texcoord_max.y));
+
+	mesh.vertices.resize(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Vertex& v = vertices[i];
+		QuantizedVertex& q = mesh.vertices[i];
+
+		q.position = math::ushort4(quantizeUnorm16(v.position.x, mesh.position_offset.x, mesh.position_scale.x),
+		                           quantizeUnorm16(v.position.y, mesh.position_offset.y, mesh.position_scale.y),
+		                           quantizeUnorm16(v.position.z, mesh.position_offset.z, mesh.position_scale.z),
+		                           0);
+		q.normal = encodeOctahedral(v.normal);
+		q.texcoord = math::ushort2(quantizeUnorm16(v.texcoord.x, mesh.texcoord_offset.x, mesh.texcoord_scale.x),
+		                           quantizeUnorm16(v.texcoord.y, mesh.texcoord_offset.y, mesh.texcoord_scale.y));
+	}
+
+	return mesh;
+}
+
+QuantizationError measureQuantizationError(const Vertex* vertices, const QuantizedMesh& mesh)
+{
+	QuantizationError error = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+	{
+		const QuantizedVertex& q = mesh.vertices[i];
+
+		error.position = std::max(error.position, length(mesh.position(q) - vertices[i].position));
+		error.normal_degrees = std::max(error.normal_degrees, angleDegrees(mesh.normal(q), vertices[i].normal));
+		error.texcoord = std::max(error.texcoord, length(mesh.texcoord(q) - vertices[i].texcoord));
+	}
+
+	float diagonal = length(mesh.position_scale * unorm16_max);
+	error.position_relative = diagonal > 0.0f ? error.position / diagonal : 0.0f;
+
+	return error;
+}
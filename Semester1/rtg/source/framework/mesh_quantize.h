@@ -0,0 +1,57 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_QUANTIZE
+#define INCLUDED_FRAMEWORK_MESH_QUANTIZE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+#include "mesh.h"
+
+
+// 16 bytes instead of the 32 of Vertex; the shader decodes
+//   position = position_offset + position.xyz * position_scale
+//   normal   = octahedral decode of normal / 32767
+//   texcoord = texcoord_offset + texcoord * texcoord_scale
+struct QuantizedVertex
+{
+	math::ushort4 position;  // 16-bit relative to the mesh bounds, w is padding
+	math::short2 normal;     // octahedral, 2x16 bit
+	math::ushort2 texcoord;  // 16-bit relative to the texcoord bounds
+};
+
+struct QuantizedMesh
+{
+	std::vector<QuantizedVertex> vertices;
+
+	math::float3 position_offset;
+	math::float3 position_scale;
+	math::float2 texcoord_offset;
+	math::float2 texcoord_scale;
+
+	math::float3 position(const QuantizedVertex& v) const;
+	math::float3 normal(const QuantizedVertex& v) const;
+	math::float2 texcoord(const QuantizedVertex& v) const;
+};
+
+struct QuantizationError
+{
+	float position;          // largest distance to the original position, in mesh units
+	float position_relative; // the same relative to the bounding box diagonal
+	float normal_degrees;    // largest angle between original and decoded normal
+	float texcoord;          // largest distance in texture space
+};
+
+math::short2 encodeOctahedral(const math::float3& n);
+math::float3 decodeOctahedral(const math::short2& e);
+
+QuantizedMesh quantizeVertices(const Vertex* vertices, std::size_t count);
+
+QuantizationError measureQuantizationError(const Vertex* vertices, const QuantizedMesh& mesh);
+
+#endif  // INCLUDED_FRAMEWORK_MESH_QUANTIZE
@@ -0,0 +1,320 @@
+
+
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <initializer_list>
+
+#include "mesh_simplify.h"
+
+
+namespace
+{
+	// symmetric 4x4 matrix of the summed plane equations, error(p) = p^T Q p
+	struct Quadric
+	{
+		double a00, a01, a02, a03;
+		double a11, a12, a13;
+		double a22, a23;
+		double a33;
+
+		Quadric()
+			: a00(0.0), a01(0.0), a02(0.0), a03(0.0), a11(0.0), a12(0.0), a13(0.0), a22(0.0), a23(0.0), a33(0.0)
+		{
+		}
+
+		// plane n.p + d = 0 with unit normal n
+		Quadric(double nx, double ny, double nz, double d, double weight)
+			: a00(weight * nx * nx), a01(weight * nx * ny), a02(weight * nx * nz), a03(weight * nx * d),
+			  a11(weight * ny * ny), a12(weight * ny * nz), a13(weight * ny * d),
+			  a22(weight * nz * nz), a23(weight * nz * d),
+			  a33(weight * d * d)
+		{
+		}
+
+		Quadric& operator +=(const Quadric& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+			a11 += q.a11; a12 += q.a12; a13 += q.a13;
+			a22 += q.a22; a23 += q.a23;
+			a33 += q.a33;
+			return *this;
+		}
+
+		double error(const math::float3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			double e = a00 * x * x + a11 * y * y + a22 * z * z + a33 +
+			           2.0 * (a01 * x * y + a02 * x * z + a03 * x + a12 * y * z + a13 * y + a23 * z);
+			return e > 0.0 ? e : 0.0;
+		}
+	};
+
+	Quadric planeQuadric(const math::float3& p, const math::float3& normal, double weight)
+	{
+		return Quadric(normal.x, normal.y, normal.z, -dot(normal, p), weight);
+	}
+
+	struct PositionKey
+	{
+		std::uint32_t bits[3];
+
+		bool operator ==(const PositionKey& k) const
+		{
+			return bits[0] == k.bits[0] && bits[1] == k.bits[1] && bits[2] == k.bits[2];
+		}
+	};
+
+	struct PositionKeyHash
+	{
+		std::size_t operator ()(const PositionKey& k) const
+		{
+			std::uint32_t h = k.bits[0] * 0x9E3779B1U;
+			h ^= k.bits[1] * 0x85EBCA77U;
+			h = (h << 13) | (h >> 19);
+			h ^= k.bits[2] * 0xC2B2AE3DU;
+			return h ^ (h >> 16);
+		}
+	};
+
+	inline std::uint64_t edgeKey(std::uint32_t a, std::uint32_t b)
+	{
+		return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+	}
+
+	enum class Kind : std::uint8_t
+	{
+		INTERIOR,
+		BORDER,
+		LOCKED
+	};
+
+	struct Collapse
+	{
+		std::uint32_t from;
+		std::uint32_t to;
+		double cost;
+
+		bool operator <(const Collapse& c) const { return cost < c.cost; }
+	};
+
+	// border edges must not move inwards, so they get a plane through the edge perpendicular to the face
+	const double border_weight = 10.0;
+}
+
+std::vector<std::uint32_t> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices,
+                                        std::size_t target_index_count, float max_error, float* error)
+{
+	std::vector<std::uint32_t> result(indices);
+	double accepted = 0.0;
+
+	std::size_t vertex_count = vertices.size();
+
+	// vertices at the same position (differing in normal or UV) are one point of the surface
+	std::vector<std::uint32_t> position_of(vertex_count);
+	std::vector<std::uint32_t> wedges(vertex_count, 0);
+	{
+		std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> first;
+		first.reserve(vertex_count);
+		for (std::uint32_t v = 0; v < vertex_count; ++v)
+		{
+			PositionKey key;
+			std::memcpy(key.bits, &vertices[v].position.x, sizeof(key.bits));
+			position_of[v] = first.insert(std::make_pair(key, v)).first->second;
+			++wedges[position_of[v]];
+		}
+	}
+
+	auto position = [&](std::uint32_t v) -> const math::float3& { return vertices[v].position; };
+
+	// edges used by one triangle are borders, by more than two non-manifold
+	std::unordered_map<std::uint64_t, std::uint32_t> edge_use;
+	auto countEdges = [&](const std::vector<std::uint32_t>& triangles)
+	{
+		edge_use.clear();
+		edge_use.reserve(triangles.size());
+		for (std::size_t i = 0; i < triangles.size(); i += 3)
+			for (int k = 0; k < 3; ++k)
+				++edge_use[edgeKey(position_of[triangles[i + k]], position_of[triangles[i + (k + 1) % 3]])];
+	};
+	auto isBorder = [&](std::uint32_t a, std::uint32_t b)
+	{
+		auto e = edge_use.find(edgeKey(a, b));
+		return e != edge_use.end() && e->second == 1;
+	};
+
+	countEdges(indices);
+
+	std::vector<Kind> kind(vertex_count, Kind::INTERIOR);
+	for (std::uint32_t v = 0; v < vertex_count; ++v)
+		if (wedges[position_of[v]] > 1)
+			kind[position_of[v]] = Kind::LOCKED;
+
+	for (auto&& e : edge_use)
+	{
+		std::uint32_t a = static_cast<std::uint32_t>(e.first >> 32), b = static_cast<std::uint32_t>(e.first);
+		for (std::uint32_t v : { a, b })
+		{
+			if (e.second > 2)
+				kind[v] = Kind::LOCKED;
+			else if (e.second == 1 && kind[v] == Kind::INTERIOR)
+				kind[v] = Kind::BORDER;
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertex_count);
+	for (std::size_t i = 0; i < indices.size(); i += 3)
+	{
+		std::uint32_t p[3] = { position_of[indices[i]], position_of[indices[i + 1]], position_of[indices[i + 2]] };
+		math::float3 n = cross(position(p[1]) - position(p[0]), position(p[2]) - position(p[0]));
+		float area = length(n);
+		if (area == 0.0f)
+			continue;
+		n = n * (1.0f / area);
+
+		Quadric face = planeQuadric(position(p[0]), n, 1.0);
+		for (int k = 0; k < 3; ++k)
+			quadrics[p[k]] += face;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			std::uint32_t a = p[k], b = p[(k + 1) % 3];
+			if (!isBorder(a, b))
+				continue;
+
+			math::float3 edge = position(b) - position(a);
+			math::float3 side = cross(edge, n);
+			float side_length = length(side);
+			if (side_length == 0.0f)
+				continue;
+
+			Quadric border = planeQuadric(position(a), side * (1.0f / side_length), border_weight);
+			quadrics[a] += border;
+			quadrics[b] += border;
+		}
+	}
+
+	double max_cost = static_cast<double>(max_error) * max_error;
+
+	std::vector<std::uint32_t> remap(vertex_count);
+	std::vector<bool> touched(vertex_count);
+	std::vector<std::uint32_t> adjacency_offset(vertex_count + 1);
+	std::vector<std::uint32_t> adjacency;
+	std::vector<Collapse> candidates;
+
+	for (bool first_pass = true; result.size() > target_index_count; first_pass = false)
+	{
+		// collapses along a border join border vertices that were not neighbours before
+		if (!first_pass)
+			countEdges(result);
+
+		// triangles around each vertex, for the flip test
+		std::fill(adjacency_offset.begin(), adjacency_offset.end(), 0);
+		for (std::uint32_t i : result)
+			++adjacency_offset[i + 1];
+		for (std::size_t v = 0; v < vertex_count; ++v)
+			adjacency_offset[v + 1] += adjacency_offset[v];
+		adjacency.resize(result.size());
+		{
+			std::vector<std::uint32_t> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+			for (std::size_t i = 0; i < result.size(); ++i)
+				adjacency[fill[result[i]]++] = static_cast<std::uint32_t>(i / 3);
+		}
+
+		candidates.clear();
+		for (std::size_t i = 0; i < result.size(); i += 3)
+			for (int k = 0; k < 3; ++k)
+			{
+				std::uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+
+				for (int direction = 0; direction < 2; ++direction, std::swap(a, b))
+				{
+					Kind from = kind[position_of[a]];
+					if (from == Kind::LOCKED)
+						continue;
+					if (from == Kind::BORDER && !isBorder(position_of[a], position_of[b]))
+						continue;
+
+					double cost = quadrics[position_of[a]].error(position(b));
+					if (cost <= max_cost)
+						candidates.push_back(Collapse { a, b, cost });
+				}
+			}
+
+		std::sort(candidates.begin(), candidates.end());
+
+		for (std::uint32_t v = 0; v < vertex_count; ++v)
+			remap[v] = v;
+		std::fill(touched.begin(), touched.end(), false);
+
+		// small steps keep the cheap collapses of the next pass from being beaten by expensive ones of this pass
+		std::size_t to_remove = std::min((result.size() - target_index_count + 2) / 3, result.size() / 3 / 8 + 1);
+		std::size_t removed = 0;
+
+		for (const Collapse& c : candidates)
+		{
+			if (removed >= to_remove)
+				break;
+
+			std::uint32_t from_position = position_of[c.from], to_position = position_of[c.to];
+			if (touched[from_position] || touched[to_position])
+				continue;
+
+			// no triangle around the collapsing vertex may turn over
+			bool flips = false;
+			std::size_t collapsed = 0;
+			for (std::uint32_t j = adjacency_offset[c.from]; j < adjacency_offset[c.from + 1] && !flips; ++j)
+			{
+				const std::uint32_t* tri = &result[3 * adjacency[j]];
+				std::uint32_t t[3] = { remap[tri[0]], remap[tri[1]], remap[tri[2]] };
+
+				if (position_of[t[0]] == to_position || position_of[t[1]] == to_position || position_of[t[2]] == to_position)
+				{
+					++collapsed;
+					continue;
+				}
+
+				math::float3 before = cross(position(t[1]) - position(t[0]), position(t[2]) - position(t[0]));
+				for (int k = 0; k < 3; ++k)
+					if (t[k] == c.from)
+						t[k] = c.to;
+				math::float3 after = cross(position(t[1]) - position(t[0]), position(t[2]) - position(t[0]));
+
+				flips = dot(before, after) <= 0.0f;
+			}
+
+			if (flips)
+				continue;
+
+			remap[c.from] = c.to;
+			quadrics[to_position] += quadrics[from_position];
+			touched[from_position] = touched[to_position] = true;
+			removed += collapsed;
+			accepted = std::max(accepted, c.cost);
+		}
+
+		if (removed == 0)
+			break;
+
+		// apply the collapses and drop the triangles that lost their area
+		std::size_t write = 0;
+		for (std::size_t i = 0; i < result.size(); i += 3)
+		{
+			std::uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+			std::uint32_t pa = position_of[a], pb = position_of[b], pc = position_of[c];
+			if (pa == pb || pb == pc || pa == pc)
+				continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	if (error)
+		*error = static_cast<float>(std::sqrt(accepted));
+
+	return result;
+}
@@ -0,0 +1,25 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_MESH_SIMPLIFY
+#define INCLUDED_FRAMEWORK_MESH_SIMPLIFY
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.h"
+
+
+// quadric error metric edge collapse (Garland and Heckbert) that only moves vertices onto existing ones,
+// so the result indexes the same vertex buffer; vertices on attribute seams stay where they are and
+// borders only shrink along themselves
+//
+// returns the simplified triangle list with at most target_index_count indices if that is reachable
+// below max_error (in mesh units); error receives the largest deviation that was accepted
+std::vector<std::uint32_t> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices,
+                                        std::size_t target_index_count, float max_error, float* error = nullptr);
+
+#endif  // INCLUDED_FRAMEWORK_MESH_SIMPLIFY
@@ -0,0 +1,469 @@
+
+
+
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+
+#include "instrumentation/profiler.h"
+#include "parallel.h"
+#include "mapped_file.h"
+#include "obj.h"
+
+
+namespace
+{
+	const double powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	inline bool isDigit(char c)
+	{
+		return static_cast<unsigned char>(c - '0') < 10U;
+	}
+
+	inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char* skipSpace(const char* p, const char* end)
+	{
+		while (p != end && isSpace(*p))
+			++p;
+		return p;
+	}
+
+	inline const char* skipToken(const char* p, const char* end)
+	{
+		while (p != end && !isSpace(*p))
+			++p;
+		return p;
+	}
+
+	// a newline-aligned slice of the file parsed independently of the others; negative (relative)
+	// indices cannot be resolved before the element counts of all preceding chunks are known,
+	// so the corners that hold them are remembered and rebased when the chunks are stitched
+	struct Chunk
+	{
+		OBJ::Mesh mesh;
+		std::vector<std::size_t> relative_positions;
+		std::vector<std::size_t> relative_texcoords;
+		std::vector<std::size_t> relative_normals;
+	};
+
+	class Parser
+	{
+	private:
+		Chunk& chunk;
+		OBJ::Mesh& mesh;
+		std::size_t line_number;
+
+		[[noreturn]] void error(const char* msg) const
+		{
+			throw std::runtime_error("OBJ line " + std::to_string(line_number) + ": " + msg);
+		}
+
+		const char* readFloat(const char* p, const char* end, float& value) const
+		{
+			p = OBJ::parseFloat(skipSpace(p, end), end, value);
+			if (p == nullptr)
+				error("expected number");
+			return p;
+		}
+
+		enum
+		{
+			RELATIVE_V = 1,
+			RELATIVE_VT = 2,
+			RELATIVE_VN = 4
+		};
+
+		struct Corner
+		{
+			std::int32_t v, vt, vn;
+			unsigned int relative;
+		};
+
+		static std::int32_t resolveIndex(std::int32_t index, std::size_t count, Corner& corner, unsigned int flag)
+		{
+			// OBJ indices are 1-based, negative ones count back from the last element read so far
+			if (index > 0)
+				return index - 1;
+			corner.relative |= flag;
+			return static_cast<std::int32_t>(count) + index;
+		}
+
+		const char* readCorner(const char* p, const char* end, Corner& corner) const
+		{
+			std::int32_t index;
+			if ((p = OBJ::parseInt(p, end, index)) == nullptr || index == 0)
+				error("invalid vertex index");
+			corner.relative = 0;
+			corner.v = resolveIndex(index, mesh.positionCount(), corner, RELATIVE_V);
+			corner.vt = -1;
+			corner.vn = -1;
+
+			if (p != end && *p == '/')
+			{
+				if (++p != end && *p != '/')
+				{
+					if ((p = OBJ::parseInt(p, end, index)) == nullptr || index == 0)
+						error("invalid texcoord index");
+					corner.vt = resolveIndex(index, mesh.texcoordCount(), corner, RELATIVE_VT);
+				}
+				if (p != end && *p == '/')
+				{
+					if ((p = OBJ::parseInt(p + 1, end, index)) == nullptr || index == 0)
+						error("invalid normal index");
+					corner.vn = resolveIndex(index, mesh.normalCount(), corner, RELATIVE_VN);
+				}
+			}
+
+			if (p != end && !isSpace(*p))
+				error("malformed face corner");
+
+			return p;
+		}
+
+		void emit(const Corner& c)
+		{
+			if (c.relative & RELATIVE_V)
+				chunk.relative_positions.push_back(mesh.position_indices.size());
+			if (c.relative & RELATIVE_VT)
+				chunk.relative_texcoords.push_back(mesh.texcoord_indices.size());
+			if (c.relative & RELATIVE_VN)
+				chunk.relative_normals.push_back(mesh.normal_indices.size());
+
+			mesh.position_indices.push_back(c.v);
+			mesh.texcoord_indices.push_back(c.vt);
+			mesh.normal_indices.push_back(c.vn);
+		}
+
+		void parseFace(const char* p, const char* end)
+		{
+			// polygons are triangulated as a fan around their first corner
+			Corner first, previous, current;
+			int n = 0;
+			for (p = skipSpace(p, end); p != end; p = skipSpace(p, end), ++n)
+			{
+				p = readCorner(p, end, current);
+				if (n >= 2)
+				{
+					emit(first);
+					emit(previous);
+					emit(current);
+				}
+				else if (n == 0)
+					first = current;
+				previous = current;
+			}
+
+			if (n < 3)
+				error("face with less than three corners");
+		}
+
+	public:
+		Parser(Chunk& chunk)
+			: chunk(chunk),
+			  mesh(chunk.mesh),
+			  line_number(0)
+		{
+		}
+
+		void parse(const char* begin, const char* end)
+		{
+			// an empty file maps to no pages at all, memchr must not see its null pointer
+			if (begin == end)
+				return;
+
+			const char* line = begin;
+
+			for (const char* nl; (nl = static_cast<const char*>(std::memchr(line, '\n', end - line))) != nullptr; line = nl + 1)
+				parseLine(line, nl);
+
+			if (line != end)
+				parseLine(line, end);
+		}
+
+		void parseLine(const char* p, const char* end)
+		{
+			++line_number;
+
+			p = skipSpace(p, end);
+			const char* keyword = p;
+			p = skipToken(p, end);
+			std::size_t length = p - keyword;
+
+			if (length == 1 && keyword[0] == 'v')
+			{
+				float x, y, z;
+				p = readFloat(p, end, x);
+				p = readFloat(p, end, y);
+				p = readFloat(p, end, z);
+				mesh.position_x.push_back(x);
+				mesh.position_y.push_back(y);
+				mesh.position_z.push_back(z);
+			}
+			else if (length == 2 && keyword[0] == 'v' && keyword[1] == 't')
+			{
+				float u, v = 0.0f;
+				p = readFloat(p, end, u);
+				p = skipSpace(p, end);
+				if (p != end && (p = OBJ::parseFloat(p, end, v)) == nullptr)
+					error("expected number");
+				mesh.texcoord_u.push_back(u);
+				mesh.texcoord_v.push_back(v);
+			}
+			else if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n')
+			{
+				float x, y, z;
+				p = readFloat(p, end, x);
+				p = readFloat(p, end, y);
+				p = readFloat(p, end, z);
+				mesh.normal_x.push_back(x);
+				mesh.normal_y.push_back(y);
+				mesh.normal_z.push_back(z);
+			}
+			else if (length == 1 && keyword[0] == 'f')
+			{
+				parseFace(p, end);
+			}
+			// comments, groups, materials, smoothing groups etc. are ignored
+		}
+	};
+
+	template <typename T>
+	void copyTo(std::vector<T>& dest, std::size_t offset, const std::vector<T>& src)
+	{
+		std::copy(src.begin(), src.end(), dest.begin() + offset);
+	}
+
+	void rebase(std::vector<std::int32_t>& indices, const std::vector<std::size_t>& corners, std::size_t base)
+	{
+		for (std::size_t corner : corners)
+			indices[corner] += static_cast<std::int32_t>(base);
+	}
+
+	OBJ::Mesh parse(const char* begin, const char* end, unsigned int threads)
+	{
+		if (threads <= 1)
+		{
+			Chunk chunk;
+			Parser(chunk).parse(begin, end);
+			return std::move(chunk.mesh);
+		}
+
+		// split into newline-aligned chunks of roughly equal size
+		std::vector<const char*> bounds(threads + 1);
+		bounds[0] = begin;
+		bounds[threads] = end;
+		for (unsigned int i = 1; i < threads; ++i)
+		{
+			const char* p = std::max(begin + (end - begin) * static_cast<std::size_t>(i) / threads, bounds[i - 1]);
+			const char* nl = p != end ? static_cast<const char*>(std::memchr(p, '\n', end - p)) : nullptr;
+			bounds[i] = nl ? nl + 1 : end;
+		}
+
+		std::vector<Chunk> chunks(threads);
+
+		try
+		{
+			parallel::run(threads, [&](unsigned int i)
+			{
+				PROFILE_ZONE("OBJ parse chunk");
+				Parser(chunks[i]).parse(bounds[i], bounds[i + 1]);
+			});
+		}
+		catch (const std::runtime_error&)
+		{
+			// chunk-local line numbers are meaningless, parse serially to report the error properly
+			Chunk chunk;
+			Parser(chunk).parse(begin, end);
+			throw;
+		}
+
+		// prefix sums over the per-chunk element counts give every chunk its place in the result
+		std::vector<std::size_t> position_base(threads + 1, 0);
+		std::vector<std::size_t> texcoord_base(threads + 1, 0);
+		std::vector<std::size_t> normal_base(threads + 1, 0);
+		std::vector<std::size_t> corner_base(threads + 1, 0);
+
+		for (unsigned int i = 0; i < threads; ++i)
+		{
+			position_base[i + 1] = position_base[i] + chunks[i].mesh.positionCount();
+			texcoord_base[i + 1] = texcoord_base[i] + chunks[i].mesh.texcoordCount();
+			normal_base[i + 1] = normal_base[i] + chunks[i].mesh.normalCount();
+			corner_base[i + 1] = corner_base[i] + chunks[i].mesh.position_indices.size();
+		}
+
+		OBJ::Mesh mesh;
+		mesh.position_x.resize(position_base[threads]);
+		mesh.position_y.resize(position_base[threads]);
+		mesh.position_z.resize(position_base[threads]);
+		mesh.texcoord_u.resize(texcoord_base[threads]);
+		mesh.texcoord_v.resize(texcoord_base[threads]);
+		mesh.normal_x.resize(normal_base[threads]);
+		mesh.normal_y.resize(normal_base[threads]);
+		mesh.normal_z.resize(normal_base[threads]);
+		mesh.position_indices.resize(corner_base[threads]);
+		mesh.texcoord_indices.resize(corner_base[threads]);
+		mesh.normal_indices.resize(corner_base[threads]);
+
+		parallel::run(threads, [&](unsigned int i)
+		{
+			OBJ::Mesh& m = chunks[i].mesh;
+
+			copyTo(mesh.position_x, position_base[i], m.position_x);
+			copyTo(mesh.position_y, position_base[i], m.position_y);
+			copyTo(mesh.position_z, position_base[i], m.position_z);
+			copyTo(mesh.texcoord_u, texcoord_base[i], m.texcoord_u);
+			copyTo(mesh.texcoord_v, texcoord_base[i], m.texcoord_v);
+			copyTo(mesh.normal_x, normal_base[i], m.normal_x);
+			copyTo(mesh.normal_y, normal_base[i], m.normal_y);
+			copyTo(mesh.normal_z, normal_base[i], m.normal_z);
+
+			rebase(m.position_indices, chunks[i].relative_positions, position_base[i]);
+			rebase(m.texcoord_indices, chunks[i].relative_texcoords, texcoord_base[i]);
+			rebase(m.normal_indices, chunks[i].relative_normals, normal_base[i]);
+
+			copyTo(mesh.position_indices, corner_base[i], m.position_indices);
+			copyTo(mesh.texcoord_indices, corner_base[i], m.texcoord_indices);
+			copyTo(mesh.normal_indices, corner_base[i], m.normal_indices);
+		});
+
+		return mesh;
+	}
+
+	void validate(const OBJ::Mesh& mesh)
+	{
+		for (std::size_t i = 0; i < mesh.position_indices.size(); ++i)
+		{
+			if (mesh.position_indices[i] < 0 || static_cast<std::size_t>(mesh.position_indices[i]) >= mesh.positionCount())
+				throw std::runtime_error("OBJ vertex index out of range");
+			if (mesh.texcoord_indices[i] >= 0 && static_cast<std::size_t>(mesh.texcoord_indices[i]) >= mesh.texcoordCount())
+				throw std::runtime_error("OBJ texcoord index out of range");
+			if (mesh.normal_indices[i] >= 0 && static_cast<std::size_t>(mesh.normal_indices[i]) >= mesh.normalCount())
+				throw std::runtime_error("OBJ normal index out of range");
+		}
+	}
+}
+
+namespace OBJ
+{
+	const char* parseFloat(const char* p, const char* end, float& value)
+	{
+		bool negative = false;
+		if (p != end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		// accumulate up to 18 significant digits, anything beyond only shifts the exponent
+		std::uint64_t mantissa = 0;
+		int exponent = 0;
+		bool digits = false;
+
+		for (; p != end && isDigit(*p); ++p, digits = true)
+		{
+			if (mantissa < 100000000000000000ULL)
+				mantissa = mantissa * 10 + (*p - '0');
+			else
+				++exponent;
+		}
+
+		if (p != end && *p == '.')
+		{
+			for (++p; p != end && isDigit(*p); ++p, digits = true)
+			{
+				if (mantissa < 100000000000000000ULL)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					--exponent;
+				}
+			}
+		}
+
+		if (!digits)
+			return nullptr;
+
+		if (p != end && (*p == 'e' || *p == 'E'))
+		{
+			const char* q = p + 1;
+			bool negative_exponent = false;
+			if (q != end && (*q == '-' || *q == '+'))
+				negative_exponent = *q++ == '-';
+
+			if (q != end && isDigit(*q))
+			{
+				int e = 0;
+				for (; q != end && isDigit(*q); ++q)
+					if (e < 10000)
+						e = e * 10 + (*q - '0');
+				exponent += negative_exponent ? -e : e;
+				p = q;
+			}
+		}
+
+		double v = static_cast<double>(mantissa);
+		for (; exponent > 22; exponent -= 22)
+			v *= powers_of_ten[22];
+		for (; exponent < -22; exponent += 22)
+			v /= powers_of_ten[22];
+		v = exponent < 0 ? v / powers_of_ten[-exponent] : v * powers_of_ten[exponent];
+
+		value = static_cast<float>(negative ? -v : v);
+		return p;
+	}
+
+	const char* parseInt(const char* p, const char* end, std::int32_t& value)
+	{
+		bool negative = false;
+		if (p != end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		if (p == end || !isDigit(*p))
+			return nullptr;
+
+		std::int64_t v = 0;
+		for (; p != end && isDigit(*p); ++p)
+			if (v <= 0x7FFFFFFF)
+				v = v * 10 + (*p - '0');
+
+		if (v > 0x7FFFFFFF)
+			return nullptr;
+
+		value = static_cast<std::int32_t>(negative ? -v : v);
+		return p;
+	}
+
+	Mesh loadMesh(const char* filename, LoadStats* stats, unsigned int threads)
+	{
+		PROFILE_ZONE("OBJ load");
+
+		auto t0 = std::chrono::steady_clock::now();
+
+		MappedFile file(filename);
+
+		// small files are not worth the thread startup
+		const std::size_t min_chunk_size = 64 * 1024;
+		if (threads == 0)
+			threads = parallel::hardwareThreads();
+		threads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(threads, file.size() / min_chunk_size)));
+
+		// lines are tokenized in place, straight out of the mapped pages
+		Mesh mesh = parse(file.begin(), file.end(), threads);
+
+		validate(mesh);
+
+		if (stats)
+		{
+			stats->bytes = file.size();
+			stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			stats->threads = threads;
+		}
+
+		return mesh;
+	}
+}
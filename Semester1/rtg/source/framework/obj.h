@@ -0,0 +1,65 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_OBJ_FILE_FORMAT
+#define INCLUDED_FRAMEWORK_OBJ_FILE_FORMAT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+
+
+namespace OBJ
+{
+	// attribute streams are stored component-wise (SoA), face corners
+	// hold 0-based indices into them; a missing texcoord or normal is -1
+	struct Mesh
+	{
+		std::vector<float> position_x;
+		std::vector<float> position_y;
+		std::vector<float> position_z;
+
+		std::vector<float> normal_x;
+		std::vector<float> normal_y;
+		std::vector<float> normal_z;
+
+		std::vector<float> texcoord_u;
+		std::vector<float> texcoord_v;
+
+		std::vector<std::int32_t> position_indices;
+		std::vector<std::int32_t> texcoord_indices;
+		std::vector<std::int32_t> normal_indices;
+
+		std::size_t positionCount() const { return position_x.size(); }
+		std::size_t normalCount() const { return normal_x.size(); }
+		std::size_t texcoordCount() const { return texcoord_u.size(); }
+		std::size_t triangleCount() const { return position_indices.size() / 3; }
+
+		math::float3 position(std::size_t i) const { return math::float3(position_x[i], position_y[i], position_z[i]); }
+		math::float3 normal(std::size_t i) const { return math::float3(normal_x[i], normal_y[i], normal_z[i]); }
+		math::float2 texcoord(std::size_t i) const { return math::float2(texcoord_u[i], texcoord_v[i]); }
+	};
+
+	struct LoadStats
+	{
+		std::size_t bytes;
+		double seconds;
+		unsigned int threads;
+
+		double throughput() const { return seconds > 0.0 ? bytes / (seconds * 1024.0 * 1024.0) : 0.0; }  // MB/s
+	};
+
+	// locale-independent number parsing; both return nullptr if no number starts at begin
+	const char* parseFloat(const char* begin, const char* end, float& value);
+	const char* parseInt(const char* begin, const char* end, std::int32_t& value);
+
+	// the file is split into newline-aligned chunks parsed on up to the given number of threads
+	// (0 = one per hardware thread); the result is identical to a serial parse
+	Mesh loadMesh(const char* filename, LoadStats* stats = nullptr, unsigned int threads = 0);
+}
+
+#endif  // INCLUDED_FRAMEWORK_OBJ_FILE_FORMAT
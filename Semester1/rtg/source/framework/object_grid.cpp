@@ -0,0 +1,52 @@
+
+
+
+#include <cmath>
+
+#include "object_grid.h"
+
+
+std::vector<GridObject> scatterGrid(const std::vector<float>& mesh_sizes, std::size_t count, float spacing, float min_tint,
+                                    std::mt19937& random)
+{
+	std::uniform_int_distribution<std::size_t> mesh(0, mesh_sizes.size() - 1);
+	std::uniform_real_distribution<float> spin(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> tint(min_tint, 1.0f);
+
+	int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+
+	std::vector<GridObject> objects;
+	objects.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		GridObject object;
+		object.mesh = mesh(random);
+
+		int x = static_cast<int>(i) % side, z = static_cast<int>(i) / side;
+		object.position = math::float3((x - 0.5f * (side - 1)) * spacing, 0.0f, (z - 0.5f * (side - 1)) * spacing);
+
+		object.scale = 0.8f * spacing / mesh_sizes[object.mesh];
+		object.spin = spin(random);
+		object.color = math::float4(tint(random), tint(random), tint(random), 1.0f);
+
+		objects.push_back(object);
+	}
+
+	return objects;
+}
+
+math::float3x4 gridTransform(const GridObject& object, const math::float3& bbox_min, const math::float3& bbox_max, float time)
+{
+	math::float3 center = (bbox_min + bbox_max) * 0.5f;
+
+	float a = object.spin * time;
+	float c = std::cos(a) * object.scale, s = std::sin(a) * object.scale;
+
+	// turn about the center of the mesh, which then lands on the object's position
+	math::float3 t = object.position - math::float3(c * center.x + s * center.z, object.scale * center.y, -s * center.x + c * center.z);
+
+	return math::float3x4(   c, 0.0f,            s, t.x,
+	                      0.0f, object.scale, 0.0f, t.y,
+	                        -s, 0.0f,            c, t.z);
+}
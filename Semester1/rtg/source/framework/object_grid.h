@@ -0,0 +1,37 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_OBJECT_GRID
+#define INCLUDED_FRAMEWORK_OBJECT_GRID
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+
+
+// one object of a demo scene: which mesh, where, how large, how fast it spins and its tint
+struct GridObject
+{
+	std::size_t mesh;
+	math::float3 position;
+	float scale;
+	float spin;
+	math::float4 color;
+};
+
+// count objects on a square grid around the origin, spacing units apart, the meshes picked at random
+// and scaled to about the same size; mesh_sizes are the diagonals of their bounding boxes, the colors
+// opaque with every channel in [min_tint, 1]
+std::vector<GridObject> scatterGrid(const std::vector<float>& mesh_sizes, std::size_t count, float spacing, float min_tint,
+                                    std::mt19937& random);
+
+// where the object is after time seconds, with its mesh spun about its center, which lands on the
+// object's position
+math::float3x4 gridTransform(const GridObject& object, const math::float3& bbox_min, const math::float3& bbox_max, float time);
+
+#endif  // INCLUDED_FRAMEWORK_OBJECT_GRID
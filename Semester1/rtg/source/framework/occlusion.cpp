@@ -0,0 +1,246 @@
+
+
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+#include "parallel.h"
+#include "occlusion.h"
+
+
+namespace
+{
+	// closer to the camera than this there is no sensible projection
+	const float min_w = 1e-5f;
+
+	struct ScreenVertex
+	{
+		float x, y, z;
+		bool in_front;
+	};
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+	: width((width + 3) / 4 * 4),
+	  height(height),
+	  depth(static_cast<std::size_t>((width + 3) / 4 * 4) * height, 1.0f),
+	  view_projection(math::identity<math::float4x4>())
+{
+}
+
+void OcclusionBuffer::begin(const math::float4x4& vp)
+{
+	view_projection = vp;
+	triangles.clear();
+}
+
+void OcclusionBuffer::addOccluder(const math::float4x4& model, const Vertex* vertices, const std::uint32_t* indices, std::size_t index_count)
+{
+	math::float4x4 M = view_projection * model;
+
+	auto project = [&](const math::float3& p) -> ScreenVertex
+	{
+		math::float4 clip = M * math::float4(p, 1.0f);
+		ScreenVertex v;
+		// between the eye and the near plane z/w leaves [0, 1] and the depth would be nearer than anything
+		v.in_front = clip.w > min_w && clip.z >= -clip.w;
+		float inv_w = v.in_front ? 1.0f / clip.w : 0.0f;
+		v.x = (clip.x * inv_w * 0.5f + 0.5f) * width;
+		v.y = (clip.y * inv_w * 0.5f + 0.5f) * height;
+		v.z = clip.z * inv_w * 0.5f + 0.5f;
+		return v;
+	};
+
+	for (std::size_t i = 0; i + 2 < index_count; i += 3)
+	{
+		ScreenVertex v[3] = { project(vertices[indices[i]].position), project(vertices[indices[i + 1]].position), project(vertices[indices[i + 2]].position) };
+		if (!v[0].in_front || !v[1].in_front || !v[2].in_front)
+			continue;
+
+		// either side may face the camera, but the edge functions want one winding
+		float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+		if (area == 0.0f)
+			continue;
+		if (area < 0.0f)
+		{
+			std::swap(v[1], v[2]);
+			area = -area;
+		}
+
+		Triangle t;
+		t.min_x = std::max(0, static_cast<int>(std::floor(std::min(v[0].x, std::min(v[1].x, v[2].x)))));
+		t.max_x = std::min(width - 1, static_cast<int>(std::ceil(std::max(v[0].x, std::max(v[1].x, v[2].x)))));
+		t.min_y = std::max(0, static_cast<int>(std::floor(std::min(v[0].y, std::min(v[1].y, v[2].y)))));
+		t.max_y = std::min(height - 1, static_cast<int>(std::ceil(std::max(v[0].y, std::max(v[1].y, v[2].y)))));
+		if (t.min_x > t.max_x || t.min_y > t.max_y)
+			continue;
+
+		for (int e = 0; e < 3; ++e)
+		{
+			const ScreenVertex& a = v[e];
+			const ScreenVertex& b = v[(e + 1) % 3];
+			t.edge_a[e] = a.y - b.y;
+			t.edge_b[e] = b.x - a.x;
+			t.edge_c[e] = a.x * b.y - b.x * a.y;
+		}
+
+		t.dzdx = ((v[1].z - v[0].z) * (v[2].y - v[0].y) - (v[2].z - v[0].z) * (v[1].y - v[0].y)) / area;
+		t.dzdy = ((v[2].z - v[0].z) * (v[1].x - v[0].x) - (v[1].z - v[0].z) * (v[2].x - v[0].x)) / area;
+		t.z0 = v[0].z - t.dzdx * v[0].x - t.dzdy * v[0].y;
+
+		triangles.push_back(t);
+	}
+}
+
+void OcclusionBuffer::rasterizeBand(int first_row, int end_row)
+{
+	std::fill(depth.begin() + static_cast<std::size_t>(first_row) * width, depth.begin() + static_cast<std::size_t>(end_row) * width, 1.0f);
+
+	for (const Triangle& t : triangles)
+	{
+		int y0 = std::max(t.min_y, first_row), y1 = std::min(t.max_y, end_row - 1);
+		if (y0 > y1)
+			continue;
+
+		// whole groups of four pixels, those outside the triangle are masked
+		int x0 = t.min_x & ~3, x1 = t.max_x;
+
+		for (int y = y0; y <= y1; ++y)
+		{
+			float py = y + 0.5f;
+			float* row = &depth[static_cast<std::size_t>(y) * width];
+
+#ifdef OCCLUSION_SSE
+			__m128 a0 = _mm_set1_ps(t.edge_a[0]), a1 = _mm_set1_ps(t.edge_a[1]), a2 = _mm_set1_ps(t.edge_a[2]);
+			__m128 r0 = _mm_set1_ps(t.edge_b[0] * py + t.edge_c[0]);
+			__m128 r1 = _mm_set1_ps(t.edge_b[1] * py + t.edge_c[1]);
+			__m128 r2 = _mm_set1_ps(t.edge_b[2] * py + t.edge_c[2]);
+			__m128 dzdx = _mm_set1_ps(t.dzdx), rz = _mm_set1_ps(t.z0 + t.dzdy * py);
+			__m128 zero = _mm_setzero_ps();
+
+			for (int x = x0; x <= x1; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f));
+
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero),
+				                                      _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero)),
+				                           _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				__m128 z = _mm_add_ps(_mm_mul_ps(dzdx, px), rz);
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearer = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+			}
+#else
+			for (int x = x0; x <= x1; ++x)
+			{
+				float px = x + 0.5f;
+				if (t.edge_a[0] * px + t.edge_b[0] * py + t.edge_c[0] < 0.0f ||
+				    t.edge_a[1] * px + t.edge_b[1] * py + t.edge_c[1] < 0.0f ||
+				    t.edge_a[2] * px + t.edge_b[2] * py + t.edge_c[2] < 0.0f)
+					continue;
+				row[x] = std::min(row[x], t.z0 + t.dzdx * px + t.dzdy * py);
+			}
+#endif
+		}
+	}
+}
+
+void OcclusionBuffer::rasterize(unsigned int workers)
+{
+	int bands = (height + band_height - 1) / band_height;
+	workers = std::max(1U, std::min(workers, static_cast<unsigned int>(bands)));
+
+	// interleaved, so the bands under the horizon and the empty sky spread over all workers
+	parallel::run(workers, [&](unsigned int w)
+	{
+		for (int band = static_cast<int>(w); band < bands; band += static_cast<int>(workers))
+			rasterizeBand(band * band_height, std::min(height, (band + 1) * band_height));
+	});
+}
+
+bool OcclusionBuffer::visible(const math::float3& bbox_min, const math::float3& bbox_max) const
+{
+	float min_x = 1e30f, max_x = -1e30f, min_y = 1e30f, max_y = -1e30f, min_z = 1e30f;
+
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		math::float4 p((corner & 1) ? bbox_max.x : bbox_min.x, (corner & 2) ? bbox_max.y : bbox_min.y, (corner & 4) ? bbox_max.z : bbox_min.z, 1.0f);
+		math::float4 clip = view_projection * p;
+
+		// reaches the near plane, there is nothing in front of it
+		if (clip.w <= min_w || clip.z < -clip.w)
+			return true;
+
+		float inv_w = 1.0f / clip.w;
+		float x = (clip.x * inv_w * 0.5f + 0.5f) * width;
+		float y = (clip.y * inv_w * 0.5f + 0.5f) * height;
+		min_x = std::min(min_x, x);
+		max_x = std::max(max_x, x);
+		min_y = std::min(min_y, y);
+		max_y = std::max(max_y, y);
+		min_z = std::min(min_z, clip.z * inv_w * 0.5f + 0.5f);
+	}
+
+	int x0 = std::max(0, static_cast<int>(std::floor(min_x))), x1 = std::min(width - 1, static_cast<int>(std::ceil(max_x)));
+	int y0 = std::max(0, static_cast<int>(std::floor(min_y))), y1 = std::min(height - 1, static_cast<int>(std::ceil(max_y)));
+
+	// off the screen, that is for the frustum culling to decide
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	// visible as soon as one pixel of its rectangle has an occluder no nearer than the box; testing a
+	// few pixels more on the sides of the rectangle can only find it visible more often
+#ifdef OCCLUSION_SSE
+	x0 &= ~3;
+	__m128 z = _mm_set1_ps(min_z);
+	for (int y = y0; y <= y1; ++y)
+	{
+		const float* row = &depth[static_cast<std::size_t>(y) * width];
+		for (int x = x0; x <= x1; x += 4)
+			if (_mm_movemask_ps(_mm_cmple_ps(z, _mm_loadu_ps(row + x))))
+				return true;
+	}
+#else
+	for (int y = y0; y <= y1; ++y)
+	{
+		const float* row = &depth[static_cast<std::size_t>(y) * width];
+		for (int x = x0; x <= x1; ++x)
+			if (min_z <= row[x])
+				return true;
+	}
+#endif
+
+	return false;
+}
+
+void OcclusionBuffer::test(const BoundingBoxes& boxes, const std::vector<std::uint32_t>& candidates, std::vector<std::uint32_t>& visible, unsigned int workers) const
+{
+	std::size_t count = candidates.size();
+	workers = std::max(1U, workers);
+
+	visible.resize(count);
+	std::vector<std::size_t> found(workers);
+	std::size_t chunk = (count + workers - 1) / workers;
+
+	parallel::run(workers, [&](unsigned int w)
+	{
+		std::size_t begin = std::min(count, w * chunk), end = std::min(count, begin + chunk), n = begin;
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			std::uint32_t c = candidates[i];
+			if (this->visible(math::float3(boxes.min_x[c], boxes.min_y[c], boxes.min_z[c]), math::float3(boxes.max_x[c], boxes.max_y[c], boxes.max_z[c])))
+				visible[n++] = c;
+		}
+		found[w] = n - begin;
+	});
+
+	parallel::compact(visible, chunk, found);
+}
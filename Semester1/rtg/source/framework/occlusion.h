@@ -0,0 +1,72 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_OCCLUSION
+#define INCLUDED_FRAMEWORK_OCCLUSION
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+#include "mesh.h"
+#include "culling.h"
+
+
+// software occlusion culling on the CPU: a few large occluders are rasterized into a small depth
+// buffer, then the bounding boxes of what might be hidden behind them are tested against it; the
+// buffer holds the nearest occluder depth of every pixel, z/w mapped to [0, 1], and is split into
+// bands of rows that the workers rasterize on their own
+class OcclusionBuffer
+{
+public:
+	static const int band_height = 8;
+
+private:
+	// screen space, counterclockwise, with the edge functions and the depth plane set up
+	struct Triangle
+	{
+		float edge_a[3], edge_b[3], edge_c[3];
+		float z0, dzdx, dzdy;
+		int min_x, max_x, min_y, max_y;
+	};
+
+	int width;
+	int height;
+	std::vector<float> depth;
+
+	math::float4x4 view_projection;
+	std::vector<Triangle> triangles;
+
+	void rasterizeBand(int first_row, int end_row);
+
+public:
+	// the width is rounded up to a multiple of 4, the SIMD width
+	OcclusionBuffer(int width, int height);
+
+	// forgets the occluders of the last frame
+	void begin(const math::float4x4& view_projection);
+
+	// triangles crossing the near plane are left out, which only makes the buffer see less
+	void addOccluder(const math::float4x4& model, const Vertex* vertices, const std::uint32_t* indices, std::size_t index_count);
+
+	// clears the depth and draws every occluder added since begin()
+	void rasterize(unsigned int workers = 1);
+
+	// false only if the whole box is behind the occluders
+	bool visible(const math::float3& bbox_min, const math::float3& bbox_max) const;
+
+	// the candidates that are not occluded, in the same order
+	void test(const BoundingBoxes& boxes, const std::vector<std::uint32_t>& candidates, std::vector<std::uint32_t>& visible,
+	          unsigned int workers = 1) const;
+
+	int bufferWidth() const { return width; }
+	int bufferHeight() const { return height; }
+	const float* data() const { return depth.data(); }
+	std::size_t triangleCount() const { return triangles.size(); }
+};
+
+#endif  // INCLUDED_FRAMEWORK_OCCLUSION
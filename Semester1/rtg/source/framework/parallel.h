@@ -0,0 +1,84 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_PARALLEL
+#define INCLUDED_FRAMEWORK_PARALLEL
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <exception>
+
+
+namespace parallel
+{
+	inline unsigned int hardwareThreads()
+	{
+		unsigned int n = std::thread::hardware_concurrency();
+		return n ? n : 1U;
+	}
+
+	// calls f(i) for every i in [0, workers) on its own thread, the calling thread runs f(0);
+	// the first exception thrown by any worker is rethrown after all of them have finished
+	template <typename F>
+	void run(unsigned int workers, F f)
+	{
+		std::vector<std::exception_ptr> errors(workers);
+		std::vector<std::thread> threads;
+		threads.reserve(workers);
+
+		for (unsigned int i = 1; i < workers; ++i)
+			threads.emplace_back([&f, &errors, i]()
+			{
+				try
+				{
+					f(i);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			});
+
+		try
+		{
+			if (workers)
+				f(0U);
+		}
+		catch (...)
+		{
+			errors[0] = std::current_exception();
+		}
+
+		for (auto&& t : threads)
+			t.join();
+
+		for (auto&& e : errors)
+			if (e)
+				std::rethrow_exception(e);
+	}
+
+	// moves the found[w] results that worker w left at the start of its range [w * chunk, ...)
+	// together at the front of items and drops the rest
+	template <typename T>
+	void compact(std::vector<T>& items, std::size_t chunk, const std::vector<std::size_t>& found)
+	{
+		std::size_t n = 0;
+		for (std::size_t w = 0; w < found.size(); ++w)
+		{
+			if (found[w] == 0)
+				continue;
+
+			auto first = items.begin() + w * chunk;
+			if (n != w * chunk)
+				std::move(first, first + found[w], items.begin() + n);
+			n += found[w];
+		}
+		items.resize(n);
+	}
+}
+
+#endif  // INCLUDED_FRAMEWORK_PARALLEL
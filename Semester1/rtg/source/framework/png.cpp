@@ -5,6 +5,7 @@
 #include <string>
 #include <stdexcept>
 
+#include "instrumentation/profiler.h"
 #include "png.h"
 
 
@@ -124,6 +125,8 @@ namespace PNG
 
 	image<std::uint32_t> loadImage2D(const char* filename)
 	{
+		PROFILE_ZONE("PNG decode");
+
 		IStream file(filename);
 
 		png_uint_32 w, h;
@@ -0,0 +1,132 @@
+
+
+
+#include <cstring>
+#include <utility>
+
+#include "render_queue.h"
+
+
+namespace
+{
+	const int id_bits = 12;
+	const int depth_bits = 24;
+
+	std::uint64_t nameId(std::unordered_map<GLuint, std::uint32_t>& ids, GLuint name)
+	{
+		std::uint32_t next = static_cast<std::uint32_t>(ids.size());
+		return ids.insert(std::make_pair(name, next)).first->second & ((1U << id_bits) - 1);
+	}
+
+	// the bits of a positive float grow with its value; the top 24 below the sign are kept
+	std::uint64_t depthBits(float depth)
+	{
+		if (!(depth > 0.0f))
+			return 0;
+		std::uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return bits >> (31 - depth_bits);
+	}
+}
+
+void RenderQueue::clear()
+{
+	items.clear();
+	entries.clear();
+}
+
+void RenderQueue::add(unsigned int pass, float depth, const DrawItem& item)
+{
+	std::uint64_t program = nameId(program_ids, item.program);
+	std::uint64_t texture = nameId(texture_ids, item.texture);
+	std::uint64_t vertex_array = nameId(vertex_array_ids, item.vertex_array);
+	std::uint64_t z = depthBits(depth);
+
+	std::uint64_t state = (program << 2 * id_bits) | (texture << id_bits) | vertex_array;
+	std::uint64_t key = static_cast<std::uint64_t>(pass < max_passes ? pass : max_passes - 1) << (64 - 4);
+
+	if (pass == TRANSPARENT_PASS)
+		key |= ((~z & ((1U << depth_bits) - 1)) << 3 * id_bits) | state;
+	else
+		key |= (state << depth_bits) | z;
+
+	entries.push_back(Entry { key, static_cast<std::uint32_t>(items.size()) });
+	items.push_back(item);
+}
+
+void RenderQueue::sort()
+{
+	std::size_t count[8][256] = {};
+	for (const Entry& e : entries)
+		for (int digit = 0; digit < 8; ++digit)
+			++count[digit][(e.key >> 8 * digit) & 0xFF];
+
+	scratch.resize(entries.size());
+
+	// least significant digit first, every pass keeps the order of the ones before it
+	for (int digit = 0; digit < 8; ++digit)
+	{
+		if (entries.empty() || count[digit][(entries[0].key >> 8 * digit) & 0xFF] == entries.size())
+			continue;
+
+		std::size_t offset[256];
+		std::size_t sum = 0;
+		for (int b = 0; b < 256; ++b)
+		{
+			offset[b] = sum;
+			sum += count[digit][b];
+		}
+
+		for (const Entry& e : entries)
+			scratch[offset[(e.key >> 8 * digit) & 0xFF]++] = e;
+
+		entries.swap(scratch);
+	}
+}
+
+void RenderQueue::submit(const std::function<void(unsigned int pass)>& begin_pass, const std::function<void(const DrawItem& item)>& set_object)
+{
+	changes = StateChanges { entries.size(), 0, 0, 0 };
+
+	// nothing is known to be bound at the start
+	bool first = true;
+	unsigned int pass = 0;
+	GLuint program = 0, texture = 0, vertex_array = 0;
+
+	glActiveTexture(GL_TEXTURE0);
+
+	for (const Entry& e : entries)
+	{
+		const DrawItem& item = items[e.item];
+
+		unsigned int item_pass = static_cast<unsigned int>(e.key >> (64 - 4));
+		if (begin_pass && (first || item_pass != pass))
+			begin_pass(item_pass);
+		pass = item_pass;
+
+		if (first || item.program != program)
+		{
+			glUseProgram(item.program);
+			program = item.program;
+			++changes.programs;
+		}
+		if (first || item.texture != texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, item.texture);
+			texture = item.texture;
+			++changes.textures;
+		}
+		if (first || item.vertex_array != vertex_array)
+		{
+			glBindVertexArray(item.vertex_array);
+			vertex_array = item.vertex_array;
+			++changes.vertex_arrays;
+		}
+		first = false;
+
+		if (set_object)
+			set_object(item);
+
+		glDrawElementsBaseVertex(GL_TRIANGLES, item.index_count, item.index_type, reinterpret_cast<const void*>(item.index_offset), item.base_vertex);
+	}
+}
@@ -0,0 +1,101 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_RENDER_QUEUE
+#define INCLUDED_FRAMEWORK_RENDER_QUEUE
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include <GL/gl.h>
+
+
+// one indexed draw with everything it needs bound; object is the caller's, handed back on submission
+// to set what differs per draw, like the model matrix
+struct DrawItem
+{
+	GLuint program;
+	GLuint vertex_array;
+	GLuint texture;
+	GLenum index_type;
+	GLsizei index_count;
+	std::size_t index_offset;
+	GLint base_vertex;
+	std::uint32_t object;
+};
+
+// binds issued by a submission; the ones that would not have changed anything are not counted
+struct StateChanges
+{
+	std::size_t draws;
+	std::size_t programs;
+	std::size_t textures;
+	std::size_t vertex_arrays;
+
+	std::size_t total() const { return programs + textures + vertex_arrays; }
+};
+
+// the draws of a frame, ordered by a 64 bit key before they go to the GL; from the top, the key holds
+//   4 bits pass | 12 bits program | 12 bits texture | 12 bits vertex array | 24 bits depth
+// so every pass is drawn in one piece, and within it the draws sharing a program, then a texture,
+// then a vertex array follow one another, front to back where all of them are the same. the
+// transparent pass puts the depth right after the pass, inverted, to go back to front.
+// the GL names are numbered in the order they first show up; past 4096 of a kind the numbers repeat,
+// which only costs binds
+class RenderQueue
+{
+public:
+	enum Pass
+	{
+		OPAQUE_PASS = 0,
+		TRANSPARENT_PASS = 1
+	};
+
+	static const unsigned int max_passes = 16;
+
+private:
+	struct Entry
+	{
+		std::uint64_t key;
+		std::uint32_t item;
+	};
+
+	std::vector<DrawItem> items;
+	std::vector<Entry> entries;
+	std::vector<Entry> scratch;
+
+	std::unordered_map<GLuint, std::uint32_t> program_ids;
+	std::unordered_map<GLuint, std::uint32_t> texture_ids;
+	std::unordered_map<GLuint, std::uint32_t> vertex_array_ids;
+
+	StateChanges changes;
+
+public:
+	void clear();
+
+	// depth is the distance from the camera along the view direction; passes are drawn in order,
+	// any above TRANSPARENT_PASS are ordered like OPAQUE_PASS
+	void add(unsigned int pass, float depth, const DrawItem& item);
+
+	// radix sort of the keys, eight bits at a time; digits that are the same for every draw are skipped
+	void sort();
+
+	// draws in the order of the last sort(), or the order of add() without one, binding only what
+	// changed from one draw to the next; begin_pass, if any, is called before the first draw of every
+	// pass, set_object before every draw with the item's program bound
+	void submit(const std::function<void(unsigned int pass)>& begin_pass, const std::function<void(const DrawItem& item)>& set_object);
+
+	std::size_t size() const { return entries.size(); }
+	const DrawItem& item(std::size_t i) const { return items[entries[i].item]; }
+	std::uint64_t key(std::size_t i) const { return entries[i].key; }
+
+	// of the last submit()
+	const StateChanges& stateChanges() const { return changes; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_RENDER_QUEUE
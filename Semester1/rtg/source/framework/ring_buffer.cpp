@@ -0,0 +1,104 @@
+
+
+
+#include <chrono>
+#include <string>
+#include <stdexcept>
+
+#include "gl_support.h"
+#include "timing.h"
+#include "ring_buffer.h"
+
+
+RingBuffer::RingBuffer(GLenum target, std::size_t frame_size, unsigned int frames_in_flight)
+	: buffer(createBuffer()),
+	  target(target),
+	  region_size(frame_size),
+	  fences(frames_in_flight ? frames_in_flight : 1, nullptr),
+	  region(0),
+	  used(0),
+	  flushed(0),
+	  mapped(nullptr),
+	  frame_count(0),
+	  stall_count(0),
+	  stall_time(0.0)
+{
+	GLsizeiptr size = static_cast<GLsizeiptr>(region_size * fences.size());
+
+	glBindBuffer(target, buffer);
+
+	if (glVersionAtLeast(4, 4) || hasGLExtension("GL_ARB_buffer_storage"))
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, size, nullptr, flags);
+		mapped = static_cast<char*>(glMapBufferRange(target, 0, size, flags));
+	}
+
+	if (!mapped)
+	{
+		glBufferData(target, size, nullptr, GL_DYNAMIC_DRAW);
+		staging.resize(region_size);
+	}
+}
+
+RingBuffer::~RingBuffer()
+{
+	for (GLsync fence : fences)
+		if (fence)
+			glDeleteSync(fence);
+}
+
+void RingBuffer::beginFrame()
+{
+	++frame_count;
+	used = 0;
+	flushed = 0;
+
+	GLsync& fence = fences[region];
+	if (!fence)
+		return;
+
+	// the common case: the GPU finished with this region long ago
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+	{
+		++stall_count;
+		auto start = std::chrono::steady_clock::now();
+		do
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		while (status == GL_TIMEOUT_EXPIRED);
+		stall_time += millisecondsSince(start);
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+RingBuffer::Allocation RingBuffer::allocate(std::size_t size, std::size_t alignment)
+{
+	std::size_t offset = (used + alignment - 1) / alignment * alignment;
+	if (offset + size > region_size)
+		throw std::runtime_error(std::string("ring buffer region of ") + std::to_string(region_size) + " bytes exhausted");
+	used = offset + size;
+
+	char* data = mapped ? mapped + region * region_size + offset : staging.data() + offset;
+	return Allocation { data, static_cast<GLintptr>(region * region_size + offset), static_cast<GLsizeiptr>(size) };
+}
+
+void RingBuffer::flush()
+{
+	// coherent mappings need nothing, the staged data goes up in one piece
+	if (!mapped && used > flushed)
+	{
+		glBindBuffer(target, buffer);
+		glBufferSubData(target, static_cast<GLintptr>(region * region_size + flushed), static_cast<GLsizeiptr>(used - flushed), staging.data() + flushed);
+	}
+	flushed = used;
+}
+
+void RingBuffer::endFrame()
+{
+	flush();
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % fences.size();
+}
@@ -0,0 +1,80 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_RING_BUFFER
+#define INCLUDED_FRAMEWORK_RING_BUFFER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/gl.h>
+
+#include "gl_objects.h"
+
+
+// streams per-frame data through one buffer split into a region per frame in flight; the CPU writes
+// the region of the current frame while the GPU may still read the ones of the previous frames, and
+// a fence per region makes sure it is done with one before it is written again
+//
+// with GL 4.4 or ARB_buffer_storage the buffer stays mapped persistent and coherent, so writes go
+// straight to memory the GPU sees; otherwise they are staged and go up with one glBufferSubData in flush()
+class RingBuffer
+{
+public:
+	struct Allocation
+	{
+		void* data;
+		GLintptr offset;  // in the buffer, for glBindBufferRange or as vertex/index offset
+		GLsizeiptr size;
+	};
+
+private:
+	Buffer buffer;
+	GLenum target;
+	std::size_t region_size;
+	std::vector<GLsync> fences;
+	unsigned int region;
+	std::size_t used;
+	std::size_t flushed;
+
+	char* mapped;
+	std::vector<char> staging;
+
+	std::size_t frame_count;
+	std::size_t stall_count;
+	double stall_time;
+
+public:
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator =(const RingBuffer&) = delete;
+
+	RingBuffer(GLenum target, std::size_t frame_size, unsigned int frames_in_flight = 3);
+	~RingBuffer();
+
+	// waits until the GPU is done with the region of this frame
+	void beginFrame();
+
+	// space in the region of this frame; throws if the frame has used up its region
+	Allocation allocate(std::size_t size, std::size_t alignment = 16);
+
+	// makes what was written since the last flush visible to commands issued after it
+	void flush();
+
+	// fences the region; call after the last command reading it
+	void endFrame();
+
+	bool persistent() const { return mapped != nullptr; }
+	std::size_t frameSize() const { return region_size; }
+
+	operator GLuint() const { return buffer; }
+
+	// frames that had to wait for the GPU to release their region, and how long in total (ms)
+	std::size_t frames() const { return frame_count; }
+	std::size_t stalls() const { return stall_count; }
+	double stallTime() const { return stall_time; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_RING_BUFFER
@@ -0,0 +1,119 @@
+
+
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include "scene_graph.h"
+
+
+math::float4x4 localMatrix(const Transform& transform)
+{
+	float sx = std::sin(transform.rotation.x), cx = std::cos(transform.rotation.x);
+	float sy = std::sin(transform.rotation.y), cy = std::cos(transform.rotation.y);
+	float sz = std::sin(transform.rotation.z), cz = std::cos(transform.rotation.z);
+
+	const math::float3& s = transform.scale;
+	const math::float3& t = transform.translation;
+
+	// Rx * Ry * Rz multiplied out, with the columns scaled
+	return math::float4x4(
+		cy * cz * s.x,                 -cy * sz * s.y,                 sy * s.z,       t.x,
+		(cx * sz + sx * sy * cz) * s.x, (cx * cz - sx * sy * sz) * s.y, -sx * cy * s.z, t.y,
+		(sx * sz - cx * sy * cz) * s.x, (sx * cz + cx * sy * sz) * s.y, cx * cy * s.z,  t.z,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+}
+
+math::float4x4 multiplyAffine(const math::float4x4& a, const math::float4x4& b)
+{
+	return math::float4x4(
+		a._11 * b._11 + a._12 * b._21 + a._13 * b._31, a._11 * b._12 + a._12 * b._22 + a._13 * b._32, a._11 * b._13 + a._12 * b._23 + a._13 * b._33, a._11 * b._14 + a._12 * b._24 + a._13 * b._34 + a._14,
+		a._21 * b._11 + a._22 * b._21 + a._23 * b._31, a._21 * b._12 + a._22 * b._22 + a._23 * b._32, a._21 * b._13 + a._22 * b._23 + a._23 * b._33, a._21 * b._14 + a._22 * b._24 + a._23 * b._34 + a._24,
+		a._31 * b._11 + a._32 * b._21 + a._33 * b._31, a._31 * b._12 + a._32 * b._22 + a._33 * b._32, a._31 * b._13 + a._32 * b._23 + a._33 * b._33, a._31 * b._14 + a._32 * b._24 + a._33 * b._34 + a._34,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+}
+
+
+SceneGraph::SceneGraph()
+	: pass(0),
+	  first_dirty(0),
+	  recomputed(0)
+{
+}
+
+SceneGraph::Node SceneGraph::add(const Transform& local, Node parent)
+{
+	if (parent != none && parent >= parents.size())
+		throw std::runtime_error("scene graph parent does not exist");
+
+	Node node = static_cast<Node>(parents.size());
+
+	parents.push_back(parent);
+	locals.push_back(local);
+	local_matrices.push_back(math::identity<math::float4x4>());
+	worlds.push_back(math::identity<math::float4x4>());
+	recomputed_in.push_back(0);
+	dirty.push_back(1);
+
+	first_dirty = std::min<std::size_t>(first_dirty, node);
+
+	return node;
+}
+
+void SceneGraph::reserve(std::size_t count)
+{
+	parents.reserve(count);
+	locals.reserve(count);
+	local_matrices.reserve(count);
+	worlds.reserve(count);
+	recomputed_in.reserve(count);
+	dirty.reserve(count);
+}
+
+void SceneGraph::setLocal(Node node, const Transform& local)
+{
+	locals[node] = local;
+	dirty[node] = 1;
+	first_dirty = std::min<std::size_t>(first_dirty, node);
+}
+
+void SceneGraph::update()
+{
+	recomputed = 0;
+
+	std::size_t count = parents.size();
+	if (first_dirty >= count)
+		return;
+
+	// 0 is what every node starts with, it never marks a pass
+	if (++pass == 0)
+	{
+		std::fill(recomputed_in.begin(), recomputed_in.end(), 0);
+		pass = 1;
+	}
+
+	// parents come first, so one sweep sees every parent's new world matrix before its children
+	for (std::size_t i = first_dirty; i < count; ++i)
+	{
+		Node parent = parents[i];
+		bool parent_moved = parent != none && recomputed_in[parent] == pass;
+
+		if (!dirty[i] && !parent_moved)
+			continue;
+
+		if (dirty[i])
+		{
+			local_matrices[i] = localMatrix(locals[i]);
+			dirty[i] = 0;
+		}
+
+		worlds[i] = parent == none ? local_matrices[i] : multiplyAffine(worlds[parent], local_matrices[i]);
+		recomputed_in[i] = pass;
+		++recomputed;
+	}
+
+	first_dirty = count;
+}
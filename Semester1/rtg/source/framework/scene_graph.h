@@ -0,0 +1,89 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_SCENE_GRAPH
+#define INCLUDED_FRAMEWORK_SCENE_GRAPH
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+
+
+// placement of a node relative to its parent: scaled first, then rotated about x, y and z (as
+// Rx * Ry * Rz, angles in radians), then translated
+struct Transform
+{
+	math::float3 translation;
+	math::float3 rotation;
+	math::float3 scale;
+
+	Transform()
+		: translation(0.0f, 0.0f, 0.0f), rotation(0.0f, 0.0f, 0.0f), scale(1.0f, 1.0f, 1.0f)
+	{
+	}
+
+	Transform(const math::float3& translation, const math::float3& rotation, const math::float3& scale)
+		: translation(translation), rotation(rotation), scale(scale)
+	{
+	}
+};
+
+math::float4x4 localMatrix(const Transform& transform);
+
+// product of two affine matrices, the last row is not computed but taken to be (0, 0, 0, 1)
+math::float4x4 multiplyAffine(const math::float4x4& a, const math::float4x4& b);
+
+// nodes in one array each per field, a parent always before its children; a node changed since the
+// last update() has its local matrix rebuilt, and it and everything below it get their world matrix
+// recomputed, the rest keeps the cached one
+class SceneGraph
+{
+public:
+	typedef std::uint32_t Node;
+	static const Node none = ~0U;
+
+private:
+	std::vector<Node> parents;
+	std::vector<Transform> locals;
+	std::vector<math::float4x4> local_matrices;
+	std::vector<math::float4x4> worlds;
+
+	// the update pass a world matrix was last recomputed in, which tells children theirs is stale
+	std::vector<std::uint32_t> recomputed_in;
+	std::vector<std::uint8_t> dirty;
+	std::uint32_t pass;
+
+	// nothing before it is dirty
+	std::size_t first_dirty;
+	std::size_t recomputed;
+
+public:
+	SceneGraph();
+
+	// the parent has to exist already, which keeps the order topological
+	Node add(const Transform& local = Transform(), Node parent = none);
+
+	void reserve(std::size_t count);
+
+	void setLocal(Node node, const Transform& local);
+	const Transform& local(Node node) const { return locals[node]; }
+	Node parent(Node node) const { return parents[node]; }
+
+	// brings the world matrices of changed nodes and their descendants up to date
+	void update();
+
+	// as of the last update()
+	const math::float4x4& world(Node node) const { return worlds[node]; }
+
+	std::size_t size() const { return parents.size(); }
+
+	// world matrices computed by the last update()
+	std::size_t recomputedNodes() const { return recomputed; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_SCENE_GRAPH
@@ -0,0 +1,362 @@
+
+
+
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "instrumentation/profiler.h"
+#include "hash.h"
+#include "gl_support.h"
+#include "timing.h"
+#include "shader.h"
+
+
+namespace
+{
+	struct ProgramBinaryHeader
+	{
+		char magic[4];
+		std::uint32_t version;
+		std::uint64_t key;
+		std::uint32_t format;
+		std::uint32_t length;
+	};
+
+	static_assert(sizeof(ProgramBinaryHeader) == 24, "program binary header must not contain padding");
+
+	const char binary_magic[4] = { 'R', 'T', 'G', 'P' };
+	const std::uint32_t binary_version = 1;
+
+	void makeDirectory(const std::string& path)
+	{
+		// fails harmlessly if it already exists
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	const char* glString(GLenum name)
+	{
+		const char* s = reinterpret_cast<const char*>(glGetString(name));
+		return s ? s : "";
+	}
+}
+
+
+ShaderException::ShaderException(const std::string& log)
+	: std::runtime_error(log)
+{
+}
+
+void checkShader(GLuint shader)
+{
+	GLint compiled;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled == GL_TRUE)
+		return;
+
+	GLint log_length = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+	std::unique_ptr<char[]> log(new char[log_length + 1]);
+	GLsizei length = 0;
+	glGetShaderInfoLog(shader, log_length + 1, &length, log.get());
+	throw ShaderException(std::string("shader compilation failed: ") + std::string(log.get(), length));
+}
+
+void checkProgram(GLuint program)
+{
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked == GL_TRUE)
+		return;
+
+	GLint log_length = 0;
+	glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+	std::unique_ptr<char[]> log(new char[log_length + 1]);
+	GLsizei length = 0;
+	glGetProgramInfoLog(program, log_length + 1, &length, log.get());
+	throw ShaderException(std::string("program linking failed: ") + std::string(log.get(), length));
+}
+
+GLuint compileShader(GLenum type, const char* source)
+{
+	PROFILE_ZONE("shader compile");
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	try
+	{
+		checkShader(shader);
+	}
+	catch (...)
+	{
+		glDeleteShader(shader);
+		throw;
+	}
+
+	return shader;
+}
+
+void bindUniformBlock(GLuint program, const char* block_name, GLuint binding)
+{
+	GLuint index = glGetUniformBlockIndex(program, block_name);
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(program, index, binding);
+}
+
+
+ShaderProgram::ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src, bool retrievable)
+{
+	PROFILE_ZONE("shader program build");
+
+	GLuint vertex_shader = compileShader(GL_VERTEX_SHADER, vertex_shader_src);
+	GLuint fragment_shader;
+	try
+	{
+		fragment_shader = compileShader(GL_FRAGMENT_SHADER, fragment_shader_src);
+	}
+	catch (...)
+	{
+		glDeleteShader(vertex_shader);
+		throw;
+	}
+
+	program = createProgram();
+	if (retrievable)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glAttachShader(program, vertex_shader);
+	glAttachShader(program, fragment_shader);
+	glLinkProgram(program);
+
+	// the program keeps what it needs, the shader objects go away with it
+	glDetachShader(program, vertex_shader);
+	glDetachShader(program, fragment_shader);
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+
+	checkProgram(program);
+}
+
+ShaderProgram::ShaderProgram(Program program)
+	: program(std::move(program))
+{
+}
+
+ShaderProgram::ShaderProgram(ShaderProgram&& p)
+	: program(std::move(p.program))
+{
+}
+
+ShaderProgram& ShaderProgram::operator =(ShaderProgram&& p)
+{
+	program = std::move(p.program);
+	return *this;
+}
+
+GLint ShaderProgram::uniformLocation(const char* name) const
+{
+	return glGetUniformLocation(program, name);
+}
+
+
+ProgramCache::ProgramCache(std::string binary_directory)
+	: binary_directory(std::move(binary_directory)),
+	  driver_hash(0),
+	  binaries_checked(false),
+	  lookups(0),
+	  compiles(0),
+	  binary_loads(0),
+	  setup_time(0.0)
+{
+}
+
+bool ProgramCache::binariesSupported()
+{
+	if (binary_directory.empty())
+		return false;
+
+	if (!binaries_checked)
+	{
+		binaries_checked = true;
+
+		// program binaries are core since GL 4.1, the tasks ask for less
+		GLint formats = 0;
+		if (glVersionAtLeast(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		if (formats <= 0)
+		{
+			// nothing to store, do not try again
+			binary_directory.clear();
+			return false;
+		}
+
+		// binaries are only good for the driver that made them
+		std::string driver = std::string(glString(GL_VENDOR)) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+		driver_hash = hashBytes(driver.data(), driver.size());
+
+		makeDirectory(binary_directory);
+	}
+
+	return true;
+}
+
+std::string ProgramCache::binaryFilename(std::uint64_t key) const
+{
+	char name[24];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return binary_directory + '/' + name;
+}
+
+bool ProgramCache::loadBinary(std::uint64_t key, Program& program) const
+{
+	std::string filename = binaryFilename(key);
+
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+		return false;
+
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	ProgramBinaryHeader header;
+	if (data.size() < sizeof(header))
+	{
+		std::remove(filename.c_str());
+		return false;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	if (std::memcmp(header.magic, binary_magic, sizeof(binary_magic)) != 0 || header.version != binary_version ||
+	    header.key != key || header.length != data.size() - sizeof(header))
+	{
+		std::remove(filename.c_str());
+		return false;
+	}
+
+	program = createProgram();
+	glProgramBinary(program, header.format, data.data() + sizeof(header), static_cast<GLsizei>(header.length));
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE)
+	{
+		// the driver changed its mind about the format, it gets compiled and stored again
+		program = Program();
+		std::remove(filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void ProgramCache::storeBinary(std::uint64_t key, GLuint program) const
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<char> data(sizeof(ProgramBinaryHeader) + length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &written, &format, data.data() + sizeof(ProgramBinaryHeader));
+	if (written <= 0)
+		return;
+
+	ProgramBinaryHeader header;
+	std::memcpy(header.magic, binary_magic, sizeof(binary_magic));
+	header.version = binary_version;
+	header.key = key;
+	header.format = format;
+	header.length = static_cast<std::uint32_t>(written);
+	std::memcpy(data.data(), &header, sizeof(header));
+
+	// written next to it and renamed, so a crash never leaves a torn binary behind
+	std::string filename = binaryFilename(key);
+	std::string temporary = filename + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), static_cast<std::streamsize>(sizeof(header) + written));
+		if (!file)
+		{
+			file.close();
+			std::remove(temporary.c_str());
+			return;
+		}
+	}
+#ifdef _WIN32
+	std::remove(filename.c_str());
+#endif
+	if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+		std::remove(temporary.c_str());
+}
+
+const ShaderProgram& ProgramCache::get(const char* vertex_shader_src, const char* fragment_shader_src)
+{
+	++lookups;
+
+	std::uint64_t source_hashes[] = {
+		hashBytes(vertex_shader_src, std::strlen(vertex_shader_src)),
+		hashBytes(fragment_shader_src, std::strlen(fragment_shader_src))
+	};
+	std::uint64_t key = hashBytes(source_hashes, sizeof(source_hashes));
+
+	// the hash only narrows it down, the sources decide
+	auto range = programs.equal_range(key);
+	for (auto e = range.first; e != range.second; ++e)
+		if (e->second.vertex_shader_src == vertex_shader_src && e->second.fragment_shader_src == fragment_shader_src)
+			return e->second.program;
+
+	auto start = std::chrono::steady_clock::now();
+
+	Entry entry { vertex_shader_src, fragment_shader_src, ShaderProgram(Program()) };
+
+	if (binariesSupported())
+	{
+		std::uint64_t keys[] = { source_hashes[0], source_hashes[1], driver_hash };
+		std::uint64_t binary_key = hashBytes(keys, sizeof(keys));
+
+		Program program;
+		if (loadBinary(binary_key, program))
+		{
+			entry.program = ShaderProgram(std::move(program));
+			++binary_loads;
+		}
+		else
+		{
+			entry.program = ShaderProgram(vertex_shader_src, fragment_shader_src, true);
+			++compiles;
+			storeBinary(binary_key, entry.program);
+		}
+	}
+	else
+	{
+		entry.program = ShaderProgram(vertex_shader_src, fragment_shader_src);
+		++compiles;
+	}
+
+	setup_time += millisecondsSince(start);
+
+	return programs.emplace(key, std::move(entry))->second.program;
+}
+
+void ProgramCache::clear()
+{
+	programs.clear();
+}
@@ -0,0 +1,117 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_SHADER
+#define INCLUDED_FRAMEWORK_SHADER
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <GL/gl.h>
+
+#include "gl_objects.h"
+
+
+// carries the info log of a shader that failed to compile or a program that failed to link
+class ShaderException : public std::runtime_error
+{
+public:
+	explicit ShaderException(const std::string& log);
+};
+
+// throw a ShaderException with the info log if compilation or linking failed
+void checkShader(GLuint shader);
+void checkProgram(GLuint program);
+
+GLuint compileShader(GLenum type, const char* source);
+
+// connects the named uniform block of the program to a GL_UNIFORM_BUFFER binding point; a block the
+// program does not use is left alone
+void bindUniformBlock(GLuint program, const char* block_name, GLuint binding);
+
+// a linked program made of one vertex and one fragment shader; owns the GL object
+class ShaderProgram
+{
+private:
+	Program program;
+
+public:
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator =(const ShaderProgram&) = delete;
+
+	// retrievable asks the driver to keep the linked binary around for glGetProgramBinary
+	ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src, bool retrievable = false);
+
+	// takes ownership of an already linked program
+	explicit ShaderProgram(Program program);
+
+	ShaderProgram(ShaderProgram&& p);
+
+	ShaderProgram& operator =(ShaderProgram&& p);
+
+	GLint uniformLocation(const char* name) const;
+
+	operator GLuint() const { return program; }
+};
+
+// programs by the hash of their sources, so each combination is compiled and linked once;
+// needs the context the programs were made in to be current when it is cleared or destroyed
+//
+// with a binary directory, linked programs are also stored there as program binaries, keyed by the
+// sources and the GL vendor, renderer and version, and loaded instead of compiled on the next start;
+// a binary the driver rejects is dropped and the program is compiled from source again
+class ProgramCache
+{
+private:
+	struct Entry
+	{
+		std::string vertex_shader_src;
+		std::string fragment_shader_src;
+		ShaderProgram program;
+	};
+
+	std::unordered_multimap<std::uint64_t, Entry> programs;
+
+	std::string binary_directory;
+	std::uint64_t driver_hash;
+	bool binaries_checked;
+
+	std::size_t lookups;
+	std::size_t compiles;
+	std::size_t binary_loads;
+	double setup_time;
+
+	bool binariesSupported();
+	std::string binaryFilename(std::uint64_t key) const;
+	bool loadBinary(std::uint64_t key, Program& program) const;
+	void storeBinary(std::uint64_t key, GLuint program) const;
+
+public:
+	ProgramCache(const ProgramCache&) = delete;
+	ProgramCache& operator =(const ProgramCache&) = delete;
+
+	explicit ProgramCache(std::string binary_directory = std::string());
+
+	// the program for these sources, compiled and linked on first use
+	const ShaderProgram& get(const char* vertex_shader_src, const char* fragment_shader_src);
+
+	void clear();
+
+	std::size_t size() const { return programs.size(); }
+	std::size_t misses() const { return compiles + binary_loads; }
+	std::size_t hits() const { return lookups - misses(); }
+
+	// how the misses were served
+	std::size_t compiled() const { return compiles; }
+	std::size_t loadedBinaries() const { return binary_loads; }
+
+	// milliseconds spent compiling, linking and loading binaries
+	double setupTime() const { return setup_time; }
+};
+
+#endif  // INCLUDED_FRAMEWORK_SHADER
@@ -0,0 +1,160 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_STD140
+#define INCLUDED_FRAMEWORK_STD140
+
+#pragma once
+
+#include <cstddef>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+
+
+// uniform blocks declared layout(std140) as plain C++ structs: every member is a std140::member<T>,
+// which has the alignment and representation std140 gives T, so the struct can go to the buffer in
+// one piece. std140::layout<T...> computes the offsets from the std140 rules on its own; checking
+// offsetof() of the struct against it catches what C++ cannot lay out the same way, like a scalar
+// that std140 packs behind a vec3
+namespace std140
+{
+	// base alignment and size
+	template <typename T>
+	struct traits;
+
+	template <>
+	struct traits<float> { static const std::size_t alignment = 4; static const std::size_t size = 4; };
+
+	template <>
+	struct traits<int> { static const std::size_t alignment = 4; static const std::size_t size = 4; };
+
+	template <>
+	struct traits<unsigned int> { static const std::size_t alignment = 4; static const std::size_t size = 4; };
+
+	template <typename T>
+	struct traits<math::vector<T, 2U>> { static const std::size_t alignment = 2 * traits<T>::size; static const std::size_t size = 2 * traits<T>::size; };
+
+	template <typename T>
+	struct traits<math::vector<T, 3U>> { static const std::size_t alignment = 4 * traits<T>::size; static const std::size_t size = 3 * traits<T>::size; };
+
+	template <typename T>
+	struct traits<math::vector<T, 4U>> { static const std::size_t alignment = 4 * traits<T>::size; static const std::size_t size = 4 * traits<T>::size; };
+
+	// column major, every column stored as a vec4
+	template <>
+	struct traits<math::float3x3> { static const std::size_t alignment = 16; static const std::size_t size = 3 * 16; };
+
+	template <>
+	struct traits<math::float4x4> { static const std::size_t alignment = 16; static const std::size_t size = 4 * 16; };
+
+	// array elements are rounded up to vec4
+	template <typename T, std::size_t N>
+	struct traits<T[N]>
+	{
+		static const std::size_t alignment = (traits<T>::alignment + 15) / 16 * 16;
+		static const std::size_t size = N * ((traits<T>::size + alignment - 1) / alignment * alignment);
+	};
+
+
+	namespace detail
+	{
+		constexpr std::size_t align(std::size_t offset, std::size_t alignment)
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		template <std::size_t Offset, std::size_t I, typename... Members>
+		struct offset_of;
+
+		template <std::size_t Offset, typename T, typename... Members>
+		struct offset_of<Offset, 0, T, Members...>
+		{
+			static const std::size_t value = align(Offset, traits<T>::alignment);
+		};
+
+		template <std::size_t Offset, std::size_t I, typename T, typename... Members>
+		struct offset_of<Offset, I, T, Members...> : offset_of<align(Offset, traits<T>::alignment) + traits<T>::size, I - 1, Members...>
+		{
+		};
+
+		template <std::size_t Offset, typename... Members>
+		struct end_of
+		{
+			static const std::size_t value = Offset;
+		};
+
+		template <std::size_t Offset, typename T, typename... Members>
+		struct end_of<Offset, T, Members...> : end_of<align(Offset, traits<T>::alignment) + traits<T>::size, Members...>
+		{
+		};
+	}
+
+	// where std140 puts the members of a block, in declaration order
+	template <typename... Members>
+	struct layout
+	{
+		template <std::size_t I>
+		static constexpr std::size_t offset() { return detail::offset_of<0, I, Members...>::value; }
+
+		// the end of the last member, rounded up to a vec4 like a nested struct would be
+		static const std::size_t size = detail::align(detail::end_of<0, Members...>::value, 16);
+	};
+
+
+	template <typename T>
+	struct alignas(traits<T>::alignment) member
+	{
+		T value;
+
+		member& operator =(const T& v)
+		{
+			value = v;
+			return *this;
+		}
+	};
+
+	template <>
+	struct alignas(16) member<math::float3x3>
+	{
+		float columns[3][4];
+
+		member& operator =(const math::float3x3& m)
+		{
+			columns[0][0] = m._11; columns[0][1] = m._21; columns[0][2] = m._31;
+			columns[1][0] = m._12; columns[1][1] = m._22; columns[1][2] = m._32;
+			columns[2][0] = m._13; columns[2][1] = m._23; columns[2][2] = m._33;
+			return *this;
+		}
+	};
+
+	template <>
+	struct alignas(16) member<math::float4x4>
+	{
+		float columns[4][4];
+
+		member& operator =(const math::float4x4& m)
+		{
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					columns[c][r] = m._m[4 * r + c];
+			return *this;
+		}
+	};
+
+	template <typename T, std::size_t N>
+	struct member<T[N]>
+	{
+		struct alignas(traits<T[N]>::alignment) element
+		{
+			member<T> value;
+		};
+
+		element elements[N];
+
+		member<T>& operator [](std::size_t i) { return elements[i].value; }
+		const member<T>& operator [](std::size_t i) const { return elements[i].value; }
+	};
+}
+
+#endif  // INCLUDED_FRAMEWORK_STD140
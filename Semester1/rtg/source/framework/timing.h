@@ -0,0 +1,18 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_TIMING
+#define INCLUDED_FRAMEWORK_TIMING
+
+#pragma once
+
+#include <chrono>
+
+
+// wall time in milliseconds on the steady clock, what the benchmarks and load statistics print
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif  // INCLUDED_FRAMEWORK_TIMING
@@ -0,0 +1,203 @@
+
+
+
+#ifndef INCLUDED_FRAMEWORK_VERTEX_FORMAT
+#define INCLUDED_FRAMEWORK_VERTEX_FORMAT
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+#include <GL/gl.h>
+
+#include "math/vector.h"
+#include "math/matrix.h"
+
+
+// vertex attributes by meaning; T is a scalar or math::vector, Normalized maps integer components to [0, 1] or [-1, 1]
+namespace attribute
+{
+	template <typename T, bool Normalized = false>
+	struct position { typedef T type; static const bool normalized = Normalized; };
+
+	template <typename T, bool Normalized = false>
+	struct normal { typedef T type; static const bool normalized = Normalized; };
+
+	template <typename T, bool Normalized = false>
+	struct uv { typedef T type; static const bool normalized = Normalized; };
+
+	template <typename T, bool Normalized = false>
+	struct color { typedef T type; static const bool normalized = Normalized; };
+
+	// a math::matrix, one location per row
+	template <typename T>
+	struct transform { typedef T type; static const bool normalized = false; };
+}
+
+namespace detail
+{
+	template <typename T> struct gl_component_type;
+	template <> struct gl_component_type<float> { static const GLenum value = GL_FLOAT; };
+	template <> struct gl_component_type<signed char> { static const GLenum value = GL_BYTE; };
+	template <> struct gl_component_type<unsigned char> { static const GLenum value = GL_UNSIGNED_BYTE; };
+	template <> struct gl_component_type<short> { static const GLenum value = GL_SHORT; };
+	template <> struct gl_component_type<unsigned short> { static const GLenum value = GL_UNSIGNED_SHORT; };
+	template <> struct gl_component_type<int> { static const GLenum value = GL_INT; };
+	template <> struct gl_component_type<unsigned int> { static const GLenum value = GL_UNSIGNED_INT; };
+
+	template <typename T>
+	struct gl_attribute_type
+	{
+		static const GLint components = 1;
+		static const GLuint locations = 1;
+		static const GLenum type = gl_component_type<T>::value;
+	};
+
+	template <typename T, unsigned int N>
+	struct gl_attribute_type<math::vector<T, N>>
+	{
+		static const GLint components = N;
+		static const GLuint locations = 1;
+		static const GLenum type = gl_component_type<T>::value;
+	};
+
+	template <typename T, unsigned int M, unsigned int N>
+	struct gl_attribute_type<math::matrix<T, M, N>>
+	{
+		static const GLint components = N;
+		static const GLuint locations = M;
+		static const GLenum type = gl_component_type<T>::value;
+	};
+
+	template <typename... Attributes>
+	struct location_count;
+
+	template <>
+	struct location_count<> { static const GLuint value = 0; };
+
+	template <typename A, typename... Rest>
+	struct location_count<A, Rest...> { static const GLuint value = gl_attribute_type<typename A::type>::locations + location_count<Rest...>::value; };
+
+	// members in declaration order, each naturally aligned, so the layout is the one GL gets told about
+	template <typename... Attributes>
+	struct vertex_data;
+
+	template <typename A>
+	struct vertex_data<A>
+	{
+		typename A::type value;
+
+		vertex_data() = default;
+		vertex_data(const typename A::type& a) : value(a) {}
+	};
+
+	template <typename A, typename... Rest>
+	struct vertex_data<A, Rest...>
+	{
+		typedef vertex_data<Rest...> rest_type;
+
+		typename A::type value;
+		rest_type rest;
+
+		vertex_data() = default;
+		vertex_data(const typename A::type& a, const typename Rest::type&... r) : value(a), rest(r...) {}
+	};
+
+	template <std::size_t I>
+	struct vertex_element
+	{
+		template <typename V>
+		static auto get(V& v) -> decltype(vertex_element<I - 1>::get(v.rest)) { return vertex_element<I - 1>::get(v.rest); }
+
+		template <typename V>
+		static constexpr std::size_t offset() { return offsetof(V, rest) + vertex_element<I - 1>::template offset<typename V::rest_type>(); }
+	};
+
+	template <>
+	struct vertex_element<0>
+	{
+		template <typename V>
+		static auto get(V& v) -> decltype((v.value)) { return v.value; }
+
+		template <typename V>
+		static constexpr std::size_t offset() { return offsetof(V, value); }
+	};
+
+	template <std::size_t I, typename A, typename... Rest>
+	struct nth_attribute { typedef typename nth_attribute<I - 1, Rest...>::type type; };
+
+	template <typename A, typename... Rest>
+	struct nth_attribute<0, A, Rest...> { typedef A type; };
+}
+
+// compile-time description of an interleaved vertex, e.g.
+//   vertex_format<attribute::position<float3>, attribute::normal<float3>, attribute::uv<float2>>
+// attributes get consecutive locations in the order they are listed, matrices one per row
+template <typename... Attributes>
+struct vertex_format
+{
+	typedef detail::vertex_data<Attributes...> vertex;
+
+	static_assert(std::is_standard_layout<vertex>::value, "vertex attributes must be standard layout types");
+
+	static const std::size_t attribute_count = sizeof...(Attributes);
+	static const GLuint location_count = detail::location_count<Attributes...>::value;
+	static const GLsizei stride = sizeof(vertex);
+
+	template <std::size_t I>
+	struct attribute_type { typedef typename detail::nth_attribute<I, Attributes...>::type type; };
+
+	template <std::size_t I>
+	static constexpr std::size_t offset() { return detail::vertex_element<I>::template offset<vertex>(); }
+
+	template <std::size_t I>
+	static auto get(vertex& v) -> decltype(detail::vertex_element<I>::get(v)) { return detail::vertex_element<I>::get(v); }
+
+	template <std::size_t I>
+	static auto get(const vertex& v) -> decltype(detail::vertex_element<I>::get(v)) { return detail::vertex_element<I>::get(v); }
+
+	// builds the interleaved vertices from one array per attribute
+	static std::vector<vertex> interleave(std::size_t count, const typename Attributes::type*... streams)
+	{
+		std::vector<vertex> vertices;
+		vertices.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			vertices.emplace_back(streams[i]...);
+		return vertices;
+	}
+
+	// points the attributes of the bound vertex array at the buffer bound to GL_ARRAY_BUFFER; with a
+	// divisor they advance once per that many instances instead of once per vertex
+	static void configure(GLuint first_location = 0, std::size_t buffer_offset = 0, GLuint divisor = 0)
+	{
+		configure(first_location, buffer_offset, divisor, std::integral_constant<std::size_t, 0>());
+	}
+
+private:
+	template <std::size_t I>
+	static void configure(GLuint location, std::size_t buffer_offset, GLuint divisor, std::integral_constant<std::size_t, I>)
+	{
+		typedef typename attribute_type<I>::type A;
+		typedef detail::gl_attribute_type<typename A::type> gl_type;
+
+		for (GLuint row = 0; row < gl_type::locations; ++row)
+		{
+			std::size_t row_offset = row * (sizeof(typename A::type) / gl_type::locations);
+
+			glEnableVertexAttribArray(location + row);
+			glVertexAttribPointer(location + row, gl_type::components, gl_type::type, A::normalized ? GL_TRUE : GL_FALSE, stride,
+			                      reinterpret_cast<const void*>(buffer_offset + offset<I>() + row_offset));
+			glVertexAttribDivisor(location + row, divisor);
+		}
+
+		configure(location + gl_type::locations, buffer_offset, divisor, std::integral_constant<std::size_t, I + 1>());
+	}
+
+	static void configure(GLuint, std::size_t, GLuint, std::integral_constant<std::size_t, sizeof...(Attributes)>)
+	{
+	}
+};
+
+#endif  // INCLUDED_FRAMEWORK_VERTEX_FORMAT
@@ -9,6 +9,8 @@
 #include <GL/gl.h>
 
 #include <framework/BasicRenderer.h>
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
 
 
 class Renderer : public BasicRenderer
@@ -17,6 +19,11 @@ private:
 	int viewport_width;
 	int viewport_height;
 
+	ProgramCache programs;
+	GLuint program;
+
+	VertexArray vao;
+
 public:
 	Renderer(const Renderer&) = delete;
 	Renderer& operator =(const Renderer&) = delete;
@@ -1,75 +1,11 @@
 
 #include "Renderer.h"
 #include "iostream"
+#include "framework/vertex_format.h"
+#include "framework/std140.h"
+#include "framework/gl_diagnostics.h"
+#include "framework/instrumentation/profiler.h"
 
-class GLException : public std::exception
-{
-private:
-	GLint error_code;
-
-public:
-	GLException(GLint error) : error_code(error) {}
-	virtual const char* what() const noexcept
-	{
-		switch (error_code)
-		{
-		case (GL_INVALID_ENUM):
-			return "Enumeration parameter is not a legal enumeration for that function.";
-		case (GL_INVALID_VALUE):
-			return "Illegal parameter value for that function.";
-		case (GL_INVALID_OPERATION):
-			return "This operation cannot be executed in the current state of OpenGL.";
-		case (GL_STACK_OVERFLOW):
-			return "Stack overflow occurred.";
-		case (GL_STACK_UNDERFLOW):
-			return "Stack underflow occurred.";
-		case (GL_OUT_OF_MEMORY):
-			return "Out of memory.";
-		case (GL_INVALID_FRAMEBUFFER_OPERATION):
-			return "Operation could not be performed in the current state of the frame buffer.";
-		default:
-			return "Unknown error! Please check error code!";
-		}
-	}
-};
-
-#ifdef _DEBUG
-#define GL_SAFE_CALL(A) ([&]                \
-{                                           \
-	struct error_guard						\
-	{                                       \
-		~error_guard() noexcept(false)      \
-		{                                   \
-			GLenum error = glGetError();    \
-			if (error != GL_NO_ERROR)       \
-			{                               \
-				GLException ex(error);      \
-				std::cerr << ex.what();     \
-				throw ex;                   \
-			}                               \
-		}                                   \
-	} guard;                                \
-	return A;                               \
-}())
-
-class ShaderException : public std::exception {
-private: std::string log;
-public: ShaderException(std::string&& log) : log(std::move(log)) {}
-		virtual const char* what() const noexcept { return log.c_str(); }
-};
-
-void checkShader(const GLint shader) {
-	GLint isCompiled; GL_SAFE_CALL(glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled));
-	if (isCompiled != GL_TRUE) {
-		GLint log_length; GL_SAFE_CALL(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length));
-		auto buffer = std::unique_ptr<char[]>(new char[log_length]); GL_SAFE_CALL(glGetShaderInfoLog(shader, log_length, &log_length, buffer.get()));
-		ShaderException ex(std::string(buffer.get(), log_length - 1)); std::cerr << ex.what(); throw ex;
-	}
-}
-
-#else
-#define GL_SAFE_CALL(A) (A)
-#endif
 
 // 8 triangles * 3 homogenous verteces = 24 verteces (72 floats)
 GLfloat vertexList[] = {
@@ -116,6 +52,26 @@ GLfloat colorList[] = {
 
 GLfloat LIGHT[] = { 1.0f, 1.0f, 1.0f, 1.0f };
 
+// position at location 0, color at 1, normal at 2, interleaved into one buffer
+typedef vertex_format<attribute::position<math::float3>, attribute::color<math::float3>, attribute::normal<math::float3>> PyramidVertexFormat;
+
+// everything the shaders need per frame, has to match the Frame block in them
+struct FrameUniforms {
+	std140::member<math::float4x4> model;
+	std140::member<math::float4x4> view;
+	std140::member<math::float4x4> projection;
+	std140::member<math::float4> lightRGB;
+	std140::member<float> pi;
+};
+typedef std140::layout<math::float4x4, math::float4x4, math::float4x4, math::float4, float> FrameLayout;
+static_assert(offsetof(FrameUniforms, view) == FrameLayout::offset<1>() && offsetof(FrameUniforms, projection) == FrameLayout::offset<2>() &&
+	offsetof(FrameUniforms, lightRGB) == FrameLayout::offset<3>() && offsetof(FrameUniforms, pi) == FrameLayout::offset<4>(), "FrameUniforms does not match the std140 Frame block");
+static_assert(sizeof(FrameUniforms) == FrameLayout::size, "FrameUniforms does not match the std140 Frame block");
+const GLuint frameBinding = 0;
+// the frame uniforms go through a ring of three frames, written while the GPU still reads the last ones
+const std::size_t uniformRingFrameSize = 4096;
+GLint uniformAlignment = 256;
+
 
 const char* vertex_shader_src = R"""(
 #version 330
@@ -128,9 +84,13 @@ out vec4 vertex_color;
 out vec3 camera_direction;
 out vec3 fresh_normal;
 
-uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Frame {
+	mat4 Model;
+	mat4 View;
+	mat4 Projection;
+	vec4 LightRGB;
+	float PI;
+};
 
 void main(){
 	//vertex_color = vec4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -151,8 +111,13 @@ in vec3 fresh_normal;
 
 out vec4 fragment_color;
 
-uniform float PI;
-uniform vec4 LightRGB;
+layout(std140) uniform Frame {
+	mat4 Model;
+	mat4 View;
+	mat4 Projection;
+	vec4 LightRGB;
+	float PI;
+};
 
 void main(){
 	fragment_color = vertex_color / PI * LightRGB * max(dot(normalize(fresh_normal), normalize(camera_direction)), 0.0f);
@@ -160,12 +125,73 @@ void main(){
 )""";
 
 Renderer::Renderer(GL::platform::Window& window)
-	: BasicRenderer(window,3,3)
+	: BasicRenderer(window,3,3), programs("shader_cache"), uniformRing(GL_UNIFORM_BUFFER, uniformRingFrameSize)
 {
 	glClearColor(0.1f, 0.3f, 1.0f, 1.0f);
 	glClearDepth(1.0f);
 	glEnable(GL_DEPTH_TEST);
 
+	// compile and link the shaders once, or load the binary a previous run left in shader_cache
+	program = programs.get(vertex_shader_src, fragment_shader_src);
+
+	// the uniforms of every frame get their own range of the ring buffer
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	bindUniformBlock(program, "Frame", frameBinding);
+
+	// calculate the normals, the pyramid only moves through the model matrix so this is done once
+	// 8 triangles * 3 homogenous verteces = 24 verteces (72 floats)
+	GLfloat normalList[72];
+	for (int triangle = 0, triangleBase; triangle < 8; triangle++) {
+		triangleBase = triangle * 9;
+		math::vector<float, 3U> vertex1 = math::vector<float, 3U>(vertexList[triangleBase], vertexList[triangleBase + 1], vertexList[triangleBase + 2]);
+		math::vector<float, 3U> vertex2 = math::vector<float, 3U>(vertexList[triangleBase+3], vertexList[triangleBase + 4], vertexList[triangleBase + 5]);
+		math::vector<float, 3U> vertex3 = math::vector<float, 3U>(vertexList[triangleBase+6], vertexList[triangleBase + 7], vertexList[triangleBase + 8]);
+		math::vector<float, 3U> normal = normalize(cross(vertex2 - vertex1, vertex3 - vertex1));
+		// save the X coordinate
+		normalList[triangleBase] = normal.x;
+		normalList[triangleBase + 3] = normal.x;
+		normalList[triangleBase + 6] = normal.x;
+		// save the Y coordinate
+		normalList[triangleBase + 1] = normal.y;
+		normalList[triangleBase + 4] = normal.y;
+		normalList[triangleBase + 7] = normal.y;
+		// save the Z coordinate
+		normalList[triangleBase + 2] = normal.z;
+		normalList[triangleBase + 5] = normal.z;
+		normalList[triangleBase + 8] = normal.z;
+	}
+	// combine neighbour vertex normals
+	/**/
+	for (int vertex = 0, vertexBase, indexBase; vertex < 6; vertex++) {
+		vertexBase = 4 * vertex;
+		math::vector<float, 3U> newNormal = math::vector<float, 3U>(0,0,0);
+		for (int indexBase = 0; indexBase < 4; indexBase++) {
+			newNormal = newNormal + math::vector<float, 3U>(
+				normalList[sameVertexindeces[vertexBase + indexBase]], //   X
+				normalList[sameVertexindeces[vertexBase + indexBase]+1], // Y
+				normalList[sameVertexindeces[vertexBase + indexBase]+2] //  Z
+			);
+		}
+		newNormal = normalize(newNormal);
+		for (int indexBase = 0; indexBase < 4; indexBase++) {
+			normalList[sameVertexindeces[vertexBase + indexBase]] = newNormal.x;
+			normalList[sameVertexindeces[vertexBase + indexBase] + 1] = newNormal.y;
+			normalList[sameVertexindeces[vertexBase + indexBase] + 2] = newNormal.z;
+		}
+	}
+
+	// the VAO declaration and binding
+	vao = createVertexArray();
+	glBindVertexArray(vao);
+
+	// create one VOB with the interleaved vertex, color and normal data
+	std::vector<PyramidVertexFormat::vertex> vertices = PyramidVertexFormat::interleave(24,
+		reinterpret_cast<const math::float3*>(vertexList), reinterpret_cast<const math::float3*>(colorList), reinterpret_cast<const math::float3*>(normalList));
+	vertexVOB = createBuffer(GL_ARRAY_BUFFER, PyramidVertexFormat::stride * vertices.size(), vertices.data());
+
+	//configzre VAO layout from the vertex format
+	PyramidVertexFormat::configure();
+
 	window.attach(this);
 }
 
@@ -181,6 +207,8 @@ float Renderer::deg2rad(float degrees) {
 
 void Renderer::render()
 {
+	PROFILE_ZONE("render");
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	//addDegree = 0;
@@ -244,13 +272,6 @@ void Renderer::render()
 
 	//std::cout << modelM << "\n" << std::endl;
 
-	GLfloat modelMGL[4][4] = {
-		{ modelM._11, modelM._12, modelM._13, modelM._14 },
-		{ modelM._21, modelM._22, modelM._23, modelM._24 },
-		{ modelM._31, modelM._32, modelM._33, modelM._34 },
-		{ modelM._41, modelM._42, modelM._43, modelM._44 }
-	};
-
 	// view matrix
 	math::vector<float, 3U> cameraPos = math::vector<float, 3U>(cameraX, cameraY, cameraZ);
 	math::vector<float, 3U> W = normalize(cameraPos - math::vector<float, 3U>(lookAtX, lookAtY, lookAtZ));
@@ -258,138 +279,47 @@ void Renderer::render()
 	math::vector<float, 3U> U = normalize(cross(cameraUP, W));
 	math::vector<float, 3U> V = cross(W, U);
 
-	GLfloat viewMGL[4][4] = {
-		{ U[0], U[1], U[2], -dot(cameraPos, U) },
-		{ V[0], V[1], V[2], -dot(cameraPos, V) },
-		{ W[0], W[1], W[2], -dot(cameraPos, W) },
-		{ 0.0f, 0.0f, 0.0f, 1.0f }
-	};
+	math::float4x4 viewM = math::float4x4(
+		U[0], U[1], U[2], -dot(cameraPos, U),
+		V[0], V[1], V[2], -dot(cameraPos, V),
+		W[0], W[1], W[2], -dot(cameraPos, W),
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
 
 	// projection matrix
 	float aspect =  float(viewport_width) / float(viewport_height),
 		tanFieldViewAngle = tan(viewAngle/2.0f);
-	GLfloat projectionMGL[4][4] = {
-		{ 1.0f / (aspect * tanFieldViewAngle), 0.0f, 0.0f, 0.0f },
-		{ 0.0f, 1.0f / tanFieldViewAngle,  0.0f, 0.0f },
-		{ 0.0f, 0.0f, -(farFrame+nearFrame)/(farFrame-nearFrame), -(2 * farFrame * nearFrame) / (farFrame - nearFrame)},
-		{ 0.0f, 0.0f, -1.0f, 0.0f }
-	};
-
-	// calculate the normals
-	// 8 triangles * 3 homogenous verteces = 24 verteces (72 floats)
-	GLfloat normalList[72];
-	for (int triangle = 0, triangleBase; triangle < 8; triangle++) {
-		triangleBase = triangle * 9;
-		math::vector<float, 3U> vertex1 = math::vector<float, 3U>(vertexList[triangleBase], vertexList[triangleBase + 1], vertexList[triangleBase + 2]);
-		math::vector<float, 3U> vertex2 = math::vector<float, 3U>(vertexList[triangleBase+3], vertexList[triangleBase + 4], vertexList[triangleBase + 5]);
-		math::vector<float, 3U> vertex3 = math::vector<float, 3U>(vertexList[triangleBase+6], vertexList[triangleBase + 7], vertexList[triangleBase + 8]);
-		math::vector<float, 3U> normal = normalize(cross(vertex2 - vertex1, vertex3 - vertex1));
-		// save the X coordinate
-		normalList[triangleBase] = normal.x;
-		normalList[triangleBase + 3] = normal.x;
-		normalList[triangleBase + 6] = normal.x;
-		// save the Y coordinate
-		normalList[triangleBase + 1] = normal.y;
-		normalList[triangleBase + 4] = normal.y;
-		normalList[triangleBase + 7] = normal.y;
-		// save the Z coordinate
-		normalList[triangleBase + 2] = normal.z;
-		normalList[triangleBase + 5] = normal.z;
-		normalList[triangleBase + 8] = normal.z;
-	}
-	// combine neighbour vertex normals
-	/**/
-	for (int vertex = 0, vertexBase, indexBase; vertex < 6; vertex++) {
-		vertexBase = 4 * vertex;
-		math::vector<float, 3U> newNormal = math::vector<float, 3U>(0,0,0);
-		for (int indexBase = 0; indexBase < 4; indexBase++) {
-			newNormal = newNormal + math::vector<float, 3U>(
-				normalList[sameVertexindeces[vertexBase + indexBase]], //   X
-				normalList[sameVertexindeces[vertexBase + indexBase]+1], // Y
-				normalList[sameVertexindeces[vertexBase + indexBase]+2] //  Z
-			);
-		}
-		newNormal = normalize(newNormal);
-		for (int indexBase = 0; indexBase < 4; indexBase++) {
-			normalList[sameVertexindeces[vertexBase + indexBase]] = newNormal.x;
-			normalList[sameVertexindeces[vertexBase + indexBase] + 1] = newNormal.y;
-			normalList[sameVertexindeces[vertexBase + indexBase] + 2] = newNormal.z;
-		}
-	}
-
-	// the VAO declaration and binding
-	GLuint vao;
-	glGenVertexArrays(1, &vao);
+	math::float4x4 projectionM = math::float4x4(
+		1.0f / (aspect * tanFieldViewAngle), 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f / tanFieldViewAngle,  0.0f, 0.0f,
+		0.0f, 0.0f, -(farFrame+nearFrame)/(farFrame-nearFrame), -(2 * farFrame * nearFrame) / (farFrame - nearFrame),
+		0.0f, 0.0f, -1.0f, 0.0f
+	);
+
+	// the VAO with the pyramid, made once in the constructor
 	glBindVertexArray(vao);
 
-	// create VOB to send vertex and color data
-	GLuint vertexVOB, colorVOB, normalVOB;
-	// request names, bind for the 1st time, bind the actual data
-	glGenBuffers(1, &vertexVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, vertexVOB);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexList), vertexList, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &colorVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, colorVOB);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(colorList), colorList, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &normalVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, normalVOB);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(normalList), normalList, GL_STATIC_DRAW);
-
-	//configzre VAO layout
-	// set position at 0
-	glBindBuffer(GL_ARRAY_BUFFER, vertexVOB);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	// set color at 1
-	glBindBuffer(GL_ARRAY_BUFFER, colorVOB);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	// set normals at 2
-	glBindBuffer(GL_ARRAY_BUFFER, normalVOB);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	// bind VAO
-	glBindVertexArray(vao);
-
-	// create program to which we connect the shaders
-	GLuint program = GL_SAFE_CALL(glCreateProgram());
-
-	// load vertex shader
-	GLuint vertexShader = GL_SAFE_CALL(glCreateShader(GL_VERTEX_SHADER));
-	GL_SAFE_CALL(glShaderSource(vertexShader, 1, &vertex_shader_src, 0));	
-	GL_SAFE_CALL(glCompileShader(vertexShader));
-	GL_SAFE_CALL(glAttachShader(program, vertexShader));
-
-	// load fragment shader
-	GLuint fragmentShader = GL_SAFE_CALL(glCreateShader(GL_FRAGMENT_SHADER));
-	GL_SAFE_CALL(glShaderSource(fragmentShader, 1, &fragment_shader_src, 0));
-	GL_SAFE_CALL(glCompileShader(fragmentShader));
-	GL_SAFE_CALL(glAttachShader(program, fragmentShader));
-
-	// link the program to the GPU
-	GL_SAFE_CALL(glLinkProgram(program));
-
-	// use the program
+	// use the program, compiled and linked once in the constructor
 	glUseProgram(program);
 
-	// link matrices to uniforms after load
-	GLint modelUniform = GL_SAFE_CALL(glGetUniformLocation(program, "Model"));
-	GL_SAFE_CALL(glUniformMatrix4fv(modelUniform, 1, GL_TRUE, *modelMGL));
-	GLint viewUniform = GL_SAFE_CALL(glGetUniformLocation(program, "View"));
-	GL_SAFE_CALL(glUniformMatrix4fv(viewUniform, 1, GL_TRUE, *viewMGL));
-	GLint projectionUniform = GL_SAFE_CALL(glGetUniformLocation(program, "Projection"));
-	GL_SAFE_CALL(glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, *projectionMGL));
-	// link uniform values to fragment shader
-	GLint piUniform = GL_SAFE_CALL(glGetUniformLocation(program, "PI"));
-	GL_SAFE_CALL(glUniform1f(piUniform, pi));
-	GLint lightUniform = GL_SAFE_CALL(glGetUniformLocation(program, "LightRGB"));
-	GL_SAFE_CALL(glUniform4f(lightUniform, LIGHT[0], LIGHT[1], LIGHT[2], LIGHT[3]));
+	// matrices and light for both shaders, written straight into the ring buffer
+	uniformRing.beginFrame();
+	RingBuffer::Allocation frameRange = uniformRing.allocate(sizeof(FrameUniforms), uniformAlignment);
+	FrameUniforms& frame = *static_cast<FrameUniforms*>(frameRange.data);
+	frame.model = modelM;
+	frame.view = viewM;
+	frame.projection = projectionM;
+	frame.lightRGB = math::float4(LIGHT[0], LIGHT[1], LIGHT[2], LIGHT[3]);
+	frame.pi = pi;
+	uniformRing.flush();
+	GL_SAFE_CALL(glBindBufferRange(GL_UNIFORM_BUFFER, frameBinding, uniformRing, frameRange.offset, frameRange.size));
 
 	// start vertex shader to draw the triangles
 	GL_SAFE_CALL(glDrawArrays(GL_TRIANGLES, 0, 24));
 
+	// the GPU is done with this frame's uniforms once it gets past here
+	uniformRing.endFrame();
+
 	swapBuffers();
 	addDegree++;
 }
\ No newline at end of file
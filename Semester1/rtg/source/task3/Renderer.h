@@ -8,9 +8,12 @@
 
 #include <GL/gl.h>
 #include <framework/BasicRenderer.h>
-#include "math\math.h"
-#include "math\vector.h"
-#include "math\matrix.h"
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
+#include <framework/ring_buffer.h>
+#include "math/math.h"
+#include "math/vector.h"
+#include "math/matrix.h"
 
 
 class Renderer : public BasicRenderer
@@ -19,6 +22,13 @@ private:
 	int viewport_width;
 	int viewport_height;
 
+	ProgramCache programs;
+	GLuint program;
+
+	VertexArray vao;
+	Buffer vertexVOB;
+	RingBuffer uniformRing;
+
 public:
 	Renderer(const Renderer&) = delete;
 	Renderer& operator =(const Renderer&) = delete;
@@ -1,106 +1,67 @@
 
 #include "Renderer.h"
 #include "iostream"
-#include "framework\png.h"
+#include "framework/mesh_cache.h"
+#include "framework/mesh_quantize.h"
+#include "framework/mesh_lod.h"
+#include "framework/vertex_format.h"
+#include "framework/std140.h"
+#include "framework/math/camera.h"
+#include "framework/gl_diagnostics.h"
+#include "framework/timing.h"
+#include "framework/instrumentation/profiler.h"
+#include <chrono>
+#include <memory>
 
-class GLException : public std::exception
-{
-private:
-	GLint error_code;
-
-public:
-	GLException(GLint error) : error_code(error) {}
-	virtual const char* what() const noexcept
-	{
-		switch (error_code)
-		{
-		case (GL_INVALID_ENUM):
-			return "Enumeration parameter is not a legal enumeration for that function.";
-		case (GL_INVALID_VALUE):
-			return "Illegal parameter value for that function.";
-		case (GL_INVALID_OPERATION):
-			return "This operation cannot be executed in the current state of OpenGL.";
-		case (GL_STACK_OVERFLOW):
-			return "Stack overflow occurred.";
-		case (GL_STACK_UNDERFLOW):
-			return "Stack underflow occurred.";
-		case (GL_OUT_OF_MEMORY):
-			return "Out of memory.";
-		case (GL_INVALID_FRAMEBUFFER_OPERATION):
-			return "Operation could not be performed in the current state of the frame buffer.";
-		default:
-			return "Unknown error! Please check error code!";
-		}
-	}
-};
-
-#ifdef _DEBUG
-#define GL_SAFE_CALL(A) ([&]                \
-{                                           \
-	struct error_guard						\
-	{                                       \
-		~error_guard() noexcept(false)      \
-		{                                   \
-			GLenum error = glGetError();    \
-			if (error != GL_NO_ERROR)       \
-			{                               \
-				GLException ex(error);      \
-				std::cerr << ex.what();     \
-				throw ex;                   \
-			}                               \
-		}                                   \
-	} guard;                                \
-	return A;                               \
-}())
-
-class ShaderException : public std::exception {
-private: std::string log;
-public: ShaderException(std::string&& log) : log(std::move(log)) {}
-		virtual const char* what() const noexcept { return log.c_str(); }
-};
-
-void checkShader(const GLint shader) {
-	GLint isCompiled; GL_SAFE_CALL(glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled));
-	if (isCompiled != GL_TRUE) {
-		GLint log_length; GL_SAFE_CALL(glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length));
-		auto buffer = std::unique_ptr<char[]>(new char[log_length]); GL_SAFE_CALL(glGetShaderInfoLog(shader, log_length, &log_length, buffer.get()));
-		ShaderException ex(std::string(buffer.get(), log_length - 1)); std::cerr << ex.what(); throw ex;
-	}
-}
-
-#else
-#define GL_SAFE_CALL(A) (A)
-#endif
 
 // for memorz leaks moving the declarations of matricesand vectors here
-math::float4x4 scaleM = math::identity<math::float4x4>();
-math::float4x4 rotationXM = math::identity<math::float4x4>();
-math::float4x4 rotationYM = math::identity<math::float4x4>();
-math::float4x4 rotationZM = math::identity<math::float4x4>();
-math::float4x4 modelM;
-math::float3 cameraPos, W, cameraUP, U, V;
-
-int totalVertexCount, totalVertexFloatCount, totalTextureUVFloatCount;
+// the model matrix comes from the scene graph
+math::float4x4 viewM, projectionM;
+math::float3 cameraPos, cameraUP;
+
+GLenum indexType;
+GLsizei indexSize;
+
+// the LODs share the index buffer, the selector picks one per frame from its projected error
+std::vector<MeshLod> meshLods;
+LodSelector lodSelector;
+math::float3 meshCenter;
+float lodThresholdPixels = 1.0f;
+// triangles drawn with and without LODs, reported every lodReportFrames frames
+unsigned long long trianglesDrawn = 0, trianglesFull = 0;
+const int lodReportFrames = 600;
+
+// time spent on uploads of finished assets per frame, in steps of at most uploadChunkBytes
+double uploadBudgetMs = 2.0;
+std::size_t uploadChunkBytes = 256 * 1024;
+std::chrono::steady_clock::time_point startTime;
+
+// position at 0, normals at 1, textUV at 2; has to match the Vertex the mesh cache stores
+typedef vertex_format<attribute::position<math::float3>, attribute::normal<math::float3>, attribute::uv<math::float2>> MeshVertexFormat;
+static_assert(MeshVertexFormat::stride == sizeof(Vertex), "vertex format does not match the mesh vertices");
+static_assert(MeshVertexFormat::offset<1>() == offsetof(Vertex, normal) && MeshVertexFormat::offset<2>() == offsetof(Vertex, texcoord), "vertex format does not match the mesh vertices");
+
+// the same attributes in 16 bytes, decoded in the vertex shader
+typedef vertex_format<attribute::position<math::ushort4>, attribute::normal<math::short2>, attribute::uv<math::ushort2>> QuantizedVertexFormat;
+static_assert(QuantizedVertexFormat::stride == sizeof(QuantizedVertex), "vertex format does not match the quantized vertices");
+static_assert(QuantizedVertexFormat::offset<1>() == offsetof(QuantizedVertex, normal) && QuantizedVertexFormat::offset<2>() == offsetof(QuantizedVertex, texcoord), "vertex format does not match the quantized vertices");
+
+// upload 16 instead of 32 bytes per vertex
+bool quantizedVertices = true;
+math::float3 positionOffset, positionScale;
+math::float2 uvOffset, uvScale;
 
 // starting afine transformation settings
+// object settings, the model node starts out with them
+const Transform modelStart(math::float3(0.0f, 0.0f, -1.5f), math::float3(0.0f, 0.0f, 0.0f), math::float3(0.15f, 0.15f, 0.15f));
 float
-// object settings
-tX = 0.0f,
-tY = 0.0f,
-tZ = -1.5f,
-rotX = 0,
-rotY = 0,
-rotZ = 0,
-sX = 0.15f,
-sY = 0.15f,
-sZ = 0.15f,
 //camera settings
 cameraX = 0.0f,
 cameraY = 0.0f,
 cameraZ = 0.0f,
-lookAtX = tX,
-lookAtY = tY,
-lookAtZ = tZ,
+lookAtX = modelStart.translation.x,
+lookAtY = modelStart.translation.y,
+lookAtZ = modelStart.translation.z,
 cameraUpX = 0.0f,
 cameraUpY = 1.0f,
 cameraUpZ = 0.0f,
@@ -108,37 +69,40 @@ cameraUpZ = 0.0f,
 nearFrame = 0.5f,
 farFrame = 5.0f;
 
-GLfloat projectionMGL[4][4] = {
-	{ 1.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 1.0f,  0.0f, 0.0f },
-	{ 0.0f, 0.0f, 1.0f, 1.0f },
-	{ 0.0f, 0.0f, -1.0f, 0.0f }
-};
-
-GLfloat viewMGL[4][4] = {
-	{ 0.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 0.0f, 0.0f, 1.0f }
-};
-
-GLfloat modelMGL[4][4] = {
-	{ 1.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 1.0f, 0.0f, 0.0f },
-	{ 0.0f, 0.0f, 1.0f, 0.0f },
-	{ 0.0f, 0.0f, 0.0f, 1.0f }
+// everything the shaders need per frame, has to match the Frame block in them
+struct FrameUniforms {
+	std140::member<math::float4x4> model;
+	std140::member<math::float4x4> view;
+	std140::member<math::float4x4> projection;
+	std140::member<math::float4> lightRGB;
+	// decoding of the quantized vertices, unused otherwise
+	std140::member<math::float3> positionOffset;
+	std140::member<math::float3> positionScale;
+	std140::member<math::float2> uvOffset;
+	std140::member<math::float2> uvScale;
+	std140::member<float> pi;
 };
+typedef std140::layout<math::float4x4, math::float4x4, math::float4x4, math::float4, math::float3, math::float3, math::float2, math::float2, float> FrameLayout;
+static_assert(offsetof(FrameUniforms, view) == FrameLayout::offset<1>() && offsetof(FrameUniforms, projection) == FrameLayout::offset<2>() &&
+	offsetof(FrameUniforms, lightRGB) == FrameLayout::offset<3>() && offsetof(FrameUniforms, positionOffset) == FrameLayout::offset<4>() &&
+	offsetof(FrameUniforms, positionScale) == FrameLayout::offset<5>() && offsetof(FrameUniforms, uvOffset) == FrameLayout::offset<6>() &&
+	offsetof(FrameUniforms, uvScale) == FrameLayout::offset<7>() && offsetof(FrameUniforms, pi) == FrameLayout::offset<8>(), "FrameUniforms does not match the std140 Frame block");
+static_assert(sizeof(FrameUniforms) == FrameLayout::size, "FrameUniforms does not match the std140 Frame block");
+const GLuint frameBinding = 0;
+// the frame uniforms go through a ring of three frames, written while the GPU still reads the last ones
+const std::size_t uniformRingFrameSize = 4096;
+GLint uniformAlignment = 256;
 
 
 // Load image for texture
-//const char* textureOBJFile = "..\\assets\\cube.obj";
-//const char* texturePNGFile = "..\\assets\\Red-brick-wall.png";
-//const char* textureOBJFile = "..\\assets\\desert.obj";
-//const char* texturePNGFile = "..\\assets\\sand.png";
-//const char* textureOBJFile = "..\\assets\\nukahedron.obj";
-//const char* texturePNGFile = "..\\assets\\nukahedron_diffuse.png";
-const char* textureOBJFile = "assets\\vader.obj";
-const char* texturePNGFile = "assets\\vader.png";
+//const char* textureOBJFile = "../assets/cube.obj";
+//const char* texturePNGFile = "../assets/Red-brick-wall.png";
+//const char* textureOBJFile = "../assets/desert.obj";
+//const char* texturePNGFile = "../assets/sand.png";
+//const char* textureOBJFile = "../assets/nukahedron.obj";
+//const char* texturePNGFile = "../assets/nukahedron_diffuse.png";
+const char* textureOBJFile = "assets/vader.obj";
+const char* texturePNGFile = "assets/vader.png";
 
 const char* vertex_shader_src = R"""(
 #version 330
@@ -151,9 +115,17 @@ out vec2 vertex_texture_UV;
 out vec3 camera_direction;
 out vec3 fresh_normal;
 
-uniform mat4 Model;
-uniform mat4 View;
-uniform mat4 Projection;
+layout(std140) uniform Frame {
+	mat4 Model;
+	mat4 View;
+	mat4 Projection;
+	vec4 LightRGB;
+	vec3 PositionOffset;
+	vec3 PositionScale;
+	vec2 UVOffset;
+	vec2 UVScale;
+	float PI;
+};
 
 void main(){
 	gl_Position = View * Model * vec4(position.x, position.y, position.z, 1.0f);
@@ -164,6 +136,52 @@ void main(){
 	gl_Position = Projection * gl_Position;
 	vertex_texture_UV = texUV;
 }
+)""";
+
+// positions and UVs are 16-bit relative to their bounds, normals octahedral 2x16 bit
+const char* quantized_vertex_shader_src = R"""(
+#version 330
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 normal;
+layout(location = 2) in vec2 texUV;
+
+out vec2 vertex_texture_UV;
+out vec3 camera_direction;
+out vec3 fresh_normal;
+
+layout(std140) uniform Frame {
+	mat4 Model;
+	mat4 View;
+	mat4 Projection;
+	vec4 LightRGB;
+	vec3 PositionOffset;
+	vec3 PositionScale;
+	vec2 UVOffset;
+	vec2 UVScale;
+	float PI;
+};
+
+vec3 octahedralDecode(vec2 e){
+	vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+void main(){
+	vec3 decodedPosition = PositionOffset + position.xyz * PositionScale;
+	vec3 decodedNormal = octahedralDecode(max(normal / 32767.0f, -1.0f));
+
+	gl_Position = View * Model * vec4(decodedPosition, 1.0f);
+	camera_direction = normalize(-1.0f * vec3(gl_Position));
+	mat3 normalMatrix = mat3(transpose(inverse(View * Model)));
+	fresh_normal = normalize(normalMatrix * decodedNormal);
+
+	gl_Position = Projection * gl_Position;
+	vertex_texture_UV = UVOffset + texUV * UVScale;
+}
 )""";
 
  const char* fragment_shader_src = R"""(
@@ -176,8 +194,17 @@ in vec3 fresh_normal;
 out vec4 fragment_color;
 
 uniform sampler2D faceTex;
-uniform float PI;
-uniform vec4 LightRGB;
+layout(std140) uniform Frame {
+	mat4 Model;
+	mat4 View;
+	mat4 Projection;
+	vec4 LightRGB;
+	vec3 PositionOffset;
+	vec3 PositionScale;
+	vec2 UVOffset;
+	vec2 UVScale;
+	float PI;
+};
 
 void main(){
 //	fragment_color = texture(faceTex, vertex_texture_UV);
@@ -186,221 +213,235 @@ void main(){
 }
 )""";
 
-Renderer::Renderer(GL::platform::Window& window)
-	: BasicRenderer(window, 3, 3)
+// the placeholder until the mesh is loaded: a cube with one normal and the full texture per face
+IndexedMesh placeholderCube()
 {
-	glClearColor(0.1f, 0.3f, 1.0f, 1.0f);
-	glClearDepth(1.0f);
-	glEnable(GL_DEPTH_TEST);
-
-	int maxV = 0,
-		maxUV = 0,
-		maxN = 0,
-		maxF = 0,
-		VIC = 0,
-		UVIC = 0,
-		NIC = 0,
-		FIC = 0;
-
-	// load OBJ file just for getting the table sizes a.k.a. first run
-	char * line = new char[200], *token1, *token2, *token3;
-	std::ifstream OBJ_FILE(textureOBJFile);
-	while (!OBJ_FILE.eof()) {
-		OBJ_FILE.getline(line, 200);
-		if (std::strncmp(line, "f ", 2) == 0) {
-			maxF += 1;
-
-			std::strtok(line, " ");	// remove the f
-			token1 = std::strtok(NULL, " "); // get 1st triplet of vertex/texture/normal
-			token2 = std::strtok(NULL, " "); // get 2nd triplet of vertex/texture/normal
-			token3 = std::strtok(NULL, " "); // get 3rd triplet of vertex/texture/normal
-
-			// check indecies for 1st vertex
-			maxV = math::max(maxV, (int) atof(std::strtok(token1, "/"))); // check vertex index
-			maxUV = math::max(maxUV, (int)atof(std::strtok(NULL, "/"))); // check texture index
-			maxN = math::max(maxN, (int)atof(std::strtok(NULL, "/"))); // check normal index
-			// check indecies for 2nd vertex
-			maxV = math::max(maxV, (int)atof(std::strtok(token2, "/"))); // check vertex index
-			maxUV = math::max(maxUV, (int)atof(std::strtok(NULL, "/"))); // check texture index
-			maxN = math::max(maxN, (int)atof(std::strtok(NULL, "/"))); // check normal index
-			// check indecies for 3rd vertex
-			maxV = math::max(maxV, (int)atof(std::strtok(token3, "/"))); // check vertex index
-			maxUV = math::max(maxUV, (int)atof(std::strtok(NULL, "/"))); // check texture index
-			maxN = math::max(maxN, (int)atof(std::strtok(NULL, "/"))); // check normal index
-		}
-	}
-	std::cout << "Max indeces of f statements: V[" << maxV << "], UV[" << maxUV << "], N[" << maxN << "], f[" << maxF << "]" << std::endl;
-
-	// load OBJ file
-	float **OBJ_VERTICES = new float* [3];
-	float **OBJ_NORMALS = new float*[3];
-	float **OBJ_TEXUV = new float*[2];
-	int **OBJ_TRIANGLE_VI = new int*[3];
-	int **OBJ_TRIANGLE_NI = new int*[3];
-	int **OBJ_TRIANGLE_TI = new int*[3];
-	for (int axis = 0; axis < 3; axis++) {
-		if (axis < 2) {
-			OBJ_TEXUV[axis] = new float[maxUV];
+	IndexedMesh cube;
+	for (int axis = 0; axis < 3; ++axis) {
+		for (float side : { -1.0f, 1.0f }) {
+			math::float3 n(0.0f), u(0.0f), v(0.0f);
+			n[axis] = side;
+			u[(axis + 1) % 3] = 1.0f;
+			v[(axis + 2) % 3] = side;
+			std::uint32_t base = (std::uint32_t)cube.vertices.size();
+			for (int corner = 0; corner < 4; ++corner) {
+				float a = corner == 1 || corner == 2 ? 1.0f : -1.0f, b = corner >= 2 ? 1.0f : -1.0f;
+				Vertex vertex = { n + u * a + v * b, n, math::float2(0.5f + 0.5f * a, 0.5f + 0.5f * b) };
+				cube.vertices.push_back(vertex);
+			}
+			for (std::uint32_t i : { 0, 1, 2, 0, 2, 3 })
+				cube.indices.push_back(base + i);
 		}
-		OBJ_VERTICES[axis] = new float[maxV];
-		OBJ_NORMALS[axis] = new float[maxN];
-		OBJ_TRIANGLE_VI[axis] = new int[maxF];
-		OBJ_TRIANGLE_NI[axis] = new int[maxF];
-		OBJ_TRIANGLE_TI[axis] = new int[maxF];
 	}
+	cube.bbox_min = math::float3(-1.0f);
+	cube.bbox_max = math::float3(1.0f);
+	return cube;
+}
 
-	// set the reader back to start
-	OBJ_FILE.clear();
-	OBJ_FILE.seekg(0, std::ios::beg);
-	while(!OBJ_FILE.eof()){
-		OBJ_FILE.getline(line,100);
-		if (std::strncmp(line, "v ", 2) == 0) {
-//			std::cout << line << std::endl;
-			std::strtok(line, " ");	// remove the v
-			OBJ_VERTICES[0][VIC] = (float)atof(std::strtok(NULL, " ")); // get the X
-			OBJ_VERTICES[1][VIC] = (float)atof(std::strtok(NULL, " ")); // get the Y
-			OBJ_VERTICES[2][VIC] = (float)atof(std::strtok(NULL, " ")); // get the Z
-			VIC += 1;
-		}
-		else if (std::strncmp(line, "vn", 2) == 0) {
-	//		std::cout << line << std::endl;
-			std::strtok(line, " ");	// remove the vn
-			OBJ_NORMALS[0][NIC] = (float)atof(std::strtok(NULL, " ")); // get the X
-			OBJ_NORMALS[1][NIC] = (float)atof(std::strtok(NULL, " ")); // get the Y
-			OBJ_NORMALS[2][NIC] = (float)atof(std::strtok(NULL, " ")); // get the Z
-			NIC += 1;
-		}
-		else if (std::strncmp(line, "vt", 2) == 0) {
-//			std::cout << line << std::endl;
-			std::strtok(line, " ");	// remove the vt
-			OBJ_TEXUV[0][UVIC] = (float)atof(std::strtok(NULL, " ")); // get the U
-			OBJ_TEXUV[1][UVIC] = 1.0f - (float)atof(std::strtok(NULL, " ")); // get the V (image height goes other waz, therefore 1 - value makes it correct)
-			UVIC += 1;
-		}
-		else if (std::strncmp(line, "f ", 2) == 0) {
-	//		std::cout << line << std::endl;
-			std::strtok(line, " ");	// remove the f
-			token1 = std::strtok(NULL, " "); // get 1st triplet of vertex/texture/normal
-			token2 = std::strtok(NULL, " "); // get 2nd triplet of vertex/texture/normal
-			token3 = std::strtok(NULL, " "); // get 3rd triplet of vertex/texture/normal
-
-			// save for 1st vertex
-			OBJ_TRIANGLE_VI[0][FIC] = (int)atof(std::strtok(token1, "/")) - 1;	//save the vertex in the vertices
-			OBJ_TRIANGLE_TI[0][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the texture in the textures
-			OBJ_TRIANGLE_NI[0][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the normal in the normals
-
-			// save for 2nd vertex
-			OBJ_TRIANGLE_VI[1][FIC] = (int)atof(std::strtok(token2, "/")) - 1;	//save the vertex in the vertices
-			OBJ_TRIANGLE_TI[1][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the texture in the textures
-			OBJ_TRIANGLE_NI[1][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the normal in the normals
-
-			// save for 3rd vertex
-			OBJ_TRIANGLE_VI[2][FIC] = (int)atof(std::strtok(token3, "/")) - 1;	//save the vertex in the vertices
-			OBJ_TRIANGLE_TI[2][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the texture in the textures
-			OBJ_TRIANGLE_NI[2][FIC] = (int)atof(std::strtok(NULL, "/")) - 1;		//save the normal in the normals
-
-			FIC += 1;
-		}
+// the mesh as it goes into the buffers, quantized where it is made; the vertices and indices
+// point into the source, which has to stay around until the upload is done
+struct MeshUpload
+{
+	QuantizedMesh quantized;
+	const Vertex* vertices;
+	std::size_t vertexCount;
+	const void* indices;
+	std::size_t indexCount;
+	std::size_t indexSize;
+	std::vector<MeshLod> lods;
+	math::float3 bboxMin, bboxMax;
+
+	const void* vertexData() const { return quantizedVertices ? static_cast<const void*>(quantized.vertices.data()) : vertices; }
+	std::size_t vertexBytes() const { return quantizedVertices ? QuantizedVertexFormat::stride * quantized.vertices.size() : MeshVertexFormat::stride * vertexCount; }
+	std::size_t indexBytes() const { return indexSize * indexCount; }
+};
+
+MeshUpload prepareMesh(const Vertex* vertices, std::size_t vertexCount, const void* indices, std::size_t indexCount, std::size_t meshIndexSize,
+	const MeshLod* lods, std::size_t lodCount, const math::float3& bboxMin, const math::float3& bboxMax)
+{
+	MeshUpload mesh = { QuantizedMesh(), vertices, vertexCount, indices, indexCount, meshIndexSize, std::vector<MeshLod>(lods, lods + lodCount), bboxMin, bboxMax };
+	if (quantizedVertices)
+		mesh.quantized = quantizeVertices(vertices, vertexCount);
+	return mesh;
+}
+
+// buffers are filled through the copy target, which no draw depends on
+void allocateBuffer(GLStateCache& glState, GLuint buffer, std::size_t size, const void* data)
+{
+	glState.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, data, GL_STATIC_DRAW);
+}
+
+void fillBuffer(GLStateCache& glState, GLuint buffer, std::size_t offset, std::size_t size, const void* data)
+{
+	glState.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, static_cast<const char*>(data) + offset);
+}
+
+// point the VAO at the buffers holding the mesh, used for the placeholder and for the loaded mesh
+void attachMesh(GLStateCache& glState, GLuint vao, GLuint vertexVOB, GLuint indexVOB, const MeshUpload& mesh)
+{
+	indexType = mesh.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	indexSize = (GLsizei)mesh.indexSize;
+	meshLods = mesh.lods;
+	meshCenter = (mesh.bboxMin + mesh.bboxMax) * 0.5f;
+
+	glState.bindVertexArray(vao);
+
+	glState.bindBuffer(GL_ARRAY_BUFFER, vertexVOB);
+	if (quantizedVertices) {
+		positionOffset = mesh.quantized.position_offset;
+		positionScale = mesh.quantized.position_scale;
+		uvOffset = mesh.quantized.texcoord_offset;
+		uvScale = mesh.quantized.texcoord_scale;
+
+		//configzre VAO layout from the vertex format
+		QuantizedVertexFormat::configure();
 	}
-	OBJ_FILE.close();
-
-	std::cout << "Index count during data copying:  V[" << VIC << "], UV[" << UVIC << "], N[" << NIC << "], f[" << FIC << "]" << std::endl;
-
-	//Prepare the data in right format
-	totalVertexCount = FIC * 3; // number of F definitions * 3 triangle vertecies
-	std::cout << totalVertexCount << std::endl;
-	totalVertexFloatCount = totalVertexCount * 3;  // number of F definitions * 3 triangle vertecies * 3 values for vertex
-	totalTextureUVFloatCount = totalVertexCount * 2;  // number of F definitions * 3 triangle vertecies * 2 values for vertex
-	GLfloat *vertexList = NULL, *normalList = NULL, *textureList = NULL;
-	vertexList = new GLfloat[totalVertexFloatCount];
-	normalList = new GLfloat[totalVertexFloatCount];
-	textureList = new GLfloat[totalTextureUVFloatCount];
-
-	for (int triangle = 0, row; triangle < FIC; triangle++) {
-		for (int vertex = 0; vertex < 3; vertex++) {
-			// row of the table if each row has the whole triangle
-			row = triangle * 9;
-			for (int axis = 0; axis < 3; axis++) {
-				// load the 3 floats for each of 3 vertexes of each of the triangles
-				vertexList[row + axis + (vertex*3)] = OBJ_VERTICES[axis][OBJ_TRIANGLE_VI[vertex][triangle]];
-				normalList[row + axis + (vertex*3)] = OBJ_NORMALS[axis][OBJ_TRIANGLE_NI[vertex][triangle]];
-			}
-			// row of the table if each row has the whole triangle UV
-			row = triangle * 6;
-			for (int axis = 0; axis < 2; axis++) {
-				// load the 2 floats for each of 3 vertexes of each of the triangles
-				textureList[row + axis + (vertex * 2)] = OBJ_TEXUV[axis][OBJ_TRIANGLE_TI[vertex][triangle]];
-			}
-		}
+	else {
+		//configzre VAO layout from the vertex format
+		MeshVertexFormat::configure();
 	}
 
-	// free memory in arrays
-	for (int i = 0; i < 3; i++) {
-		if (i < 2) {
-			delete[] OBJ_TEXUV[i];
+	// the element buffer binding is part of the VAO state
+	glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVOB);
+}
+
+// the texture with its mip levels, the smaller ones computed where it is made
+struct TextureUpload
+{
+	std::shared_ptr<const image<std::uint32_t>> base;
+	std::vector<image<std::uint32_t>> mips;
+
+	std::size_t levels() const { return mips.size() + 1; }
+	const image<std::uint32_t>& level(std::size_t i) const { return i ? mips[i - 1] : *base; }
+};
+
+TextureUpload prepareTexture(std::shared_ptr<const image<std::uint32_t>> base)
+{
+	TextureUpload texture = { base, std::vector<image<std::uint32_t>>() };
+	while (width(texture.level(texture.levels() - 1)) > 1 || height(texture.level(texture.levels() - 1)) > 1)
+		texture.mips.push_back(downsample(texture.level(texture.levels() - 1)));
+	return texture;
+}
+
+double millisecondsSinceStart()
+{
+	return millisecondsSince(startTime);
+}
+
+Renderer::Renderer(GL::platform::Window& window)
+	: BasicRenderer(window, 3, 3), programs("shader_cache"), uniformRing(GL_UNIFORM_BUFFER, uniformRingFrameSize)
+{
+	startTime = std::chrono::steady_clock::now();
+
+	modelNode = scene.add(modelStart);
+
+	glClearColor(0.1f, 0.3f, 1.0f, 1.0f);
+	glClearDepth(1.0f);
+	glState.enable(GL_DEPTH_TEST);
+	glState.activeTexture(GL_TEXTURE0);
+
+	// the VAO declaration, VOBs for the interleaved vertices and the index buffer, and the texture
+	vao = createVertexArray();
+	vertexVOB = createBuffer();
+	indexVOB = createBuffer();
+	texture = createTexture();
+
+	// draw a gray cube until the real things arrive
+	IndexedMesh cube = placeholderCube();
+	std::vector<std::uint8_t> cubeIndices = cube.packIndices();
+	MeshLod cubeLod = { 0, (std::uint32_t)cube.indices.size(), 0.0f };
+	MeshUpload placeholder = prepareMesh(cube.vertices.data(), cube.vertices.size(), cubeIndices.data(), cube.indices.size(), cube.indexSize(), &cubeLod, 1, cube.bbox_min, cube.bbox_max);
+	allocateBuffer(glState, vertexVOB, placeholder.vertexBytes(), placeholder.vertexData());
+	allocateBuffer(glState, indexVOB, placeholder.indexBytes(), placeholder.indices);
+	attachMesh(glState, vao, vertexVOB, indexVOB, placeholder);
+
+	std::uint32_t gray = 0xFF808080U;
+	glState.bindTexture(GL_TEXTURE_2D, texture);
+	GL_SAFE_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &gray));
+
+	// map the binary mesh cache next to the OBJ on a worker, it is only rebuilt when the OBJ changed;
+	// V goes the other way than the image height, therefore flip it. the worker also quantizes, the
+	// render thread only copies the result into new buffers a chunk at a time, the placeholder stays
+	// in the old ones until the last chunk is in
+	assets.loadMesh(textureOBJFile, true, [this](std::shared_ptr<const CachedMesh> source) -> AssetLoader::Upload {
+		std::shared_ptr<MeshUpload> mesh = std::make_shared<MeshUpload>(prepareMesh(source->vertices(), source->vertexCount(), source->indices(), source->indexCount(), source->indexSize(),
+			source->lods(), source->lodCount(), source->bboxMin(), source->bboxMax()));
+		std::shared_ptr<Buffer> vertices = std::make_shared<Buffer>(), indices = std::make_shared<Buffer>();
+
+		return AssetLoader::sequence({
+			[this, mesh, vertices, indices]() {
+				*vertices = createBuffer();
+				*indices = createBuffer();
+				allocateBuffer(glState, *vertices, mesh->vertexBytes(), nullptr);
+				allocateBuffer(glState, *indices, mesh->indexBytes(), nullptr);
+				return true;
+			},
+			AssetLoader::chunked(mesh->vertexBytes(), uploadChunkBytes, [this, source, mesh, vertices](std::size_t offset, std::size_t size) {
+				fillBuffer(glState, *vertices, offset, size, mesh->vertexData());
+			}),
+			AssetLoader::chunked(mesh->indexBytes(), uploadChunkBytes, [this, source, mesh, indices](std::size_t offset, std::size_t size) {
+				fillBuffer(glState, *indices, offset, size, mesh->indices);
+			}),
+			[this, source, mesh, vertices, indices]() {
+				attachMesh(glState, vao, *vertices, *indices, *mesh);
+
+				// the placeholder buffers go away with the step
+				glState.forgetBuffer(vertexVOB);
+				glState.forgetBuffer(indexVOB);
+				vertexVOB = std::move(*vertices);
+				indexVOB = std::move(*indices);
+
+				std::cout << "Mesh " << (source->mapped() ? "mapped from cache" : "rebuilt from OBJ") << ", ready after " << millisecondsSinceStart() << " ms" << std::endl;
+				std::cout << "Unique vertices: " << source->vertexCount() << " of " << meshLods[0].index_count << " face corners, " << source->indexSize() * 8 << "-bit indices" << std::endl;
+				for (std::size_t i = 0; i < meshLods.size(); ++i)
+					std::cout << "LOD " << i << ": " << meshLods[i].index_count / 3 << " triangles, error " << meshLods[i].error << std::endl;
+				return true;
+			}
+		});
+	});
+
+	// adding textures to the model, decoded and mipmapped on a worker as well, then uploaded a few rows
+	// at a time into a new texture that replaces the gray one once it is complete
+	assets.loadImage(texturePNGFile, [this](std::shared_ptr<const image<std::uint32_t>> source) -> AssetLoader::Upload {
+		std::shared_ptr<TextureUpload> upload = std::make_shared<TextureUpload>(prepareTexture(source));
+		std::shared_ptr<Texture> levels = std::make_shared<Texture>();
+
+		std::vector<AssetLoader::Upload> steps;
+		steps.push_back([this, upload, levels]() {
+			*levels = createTexture();
+			glState.bindTexture(GL_TEXTURE_2D, *levels);
+			for (std::size_t i = 0; i < upload->levels(); ++i)
+				GL_SAFE_CALL(glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, (GLsizei)width(upload->level(i)), (GLsizei)height(upload->level(i)), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+			return true;
+		});
+		for (std::size_t i = 0; i < upload->levels(); ++i) {
+			std::size_t w = width(upload->level(i));
+			steps.push_back(AssetLoader::chunked(height(upload->level(i)), std::max<std::size_t>(1, uploadChunkBytes / (4 * w)), [this, upload, levels, i, w](std::size_t row, std::size_t rows) {
+				glState.bindTexture(GL_TEXTURE_2D, *levels);
+				GL_SAFE_CALL(glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, (GLint)row, (GLsizei)w, (GLsizei)rows, GL_RGBA, GL_UNSIGNED_BYTE, data(upload->level(i)) + row * w));
+			}));
 		}
-		delete[] OBJ_VERTICES[i];
-		delete[] OBJ_NORMALS[i];
-		delete[] OBJ_TRIANGLE_VI[i];
-		delete[] OBJ_TRIANGLE_NI[i];
-		delete[] OBJ_TRIANGLE_TI[i];
-	}
-	delete[] OBJ_VERTICES;
-	delete[] OBJ_NORMALS;
-	delete[] OBJ_TEXUV;
-	delete[] OBJ_TRIANGLE_VI;
-	delete[] OBJ_TRIANGLE_NI;
-	delete[] OBJ_TRIANGLE_TI;
-
-	// the VAO declaration and binding
-	GLuint vao;
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-
-	// create VOB to send vertex and color data
-	GLuint vertexVOB, normalVOB, textUVVOB;
-	// request names, bind for the 1st time, bind the actual data
-	// the 4 * float count is since we have 32bit(4B) floats
-	glGenBuffers(1, &vertexVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, vertexVOB);
-	glBufferData(GL_ARRAY_BUFFER, 4 * totalVertexFloatCount, vertexList, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &normalVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, normalVOB);
-	glBufferData(GL_ARRAY_BUFFER, 4 * totalVertexFloatCount, normalList, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &textUVVOB);
-	glBindBuffer(GL_ARRAY_BUFFER, textUVVOB);
-	glBufferData(GL_ARRAY_BUFFER, 4 * totalTextureUVFloatCount, textureList, GL_STATIC_DRAW);
-
-	//configzre VAO layout
-	// set position at 0
-	glBindBuffer(GL_ARRAY_BUFFER, vertexVOB);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	// set normals at 1
-	glBindBuffer(GL_ARRAY_BUFFER, normalVOB);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);;
-	// set textUV at 2
-	glBindBuffer(GL_ARRAY_BUFFER, textUVVOB);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	// bind VAO
-	glBindVertexArray(vao);
-
-	// adding textures to the model
-	image<std::uint32_t> textureImage(PNG::loadImage2D(texturePNGFile));
-	GLuint texture;
-	GL_SAFE_CALL(glGenTextures(1, &texture));
-	GL_SAFE_CALL(glBindTexture(GL_TEXTURE_2D, texture));
-	GL_SAFE_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width(textureImage), height(textureImage), 0, GL_RGBA, GL_UNSIGNED_BYTE, data(textureImage)));
-	GL_SAFE_CALL(glGenerateMipmap(GL_TEXTURE_2D));
-
-	//clear arrays
-	delete[] vertexList;
-	delete[] normalList;
-	delete[] textureList;
+		steps.push_back([this, levels]() {
+			// the gray texture goes away with the step
+			glState.forgetTexture(texture);
+			texture = std::move(*levels);
+
+			std::cout << "Texture ready after " << millisecondsSinceStart() << " ms" << std::endl;
+			return true;
+		});
+
+		return AssetLoader::sequence(std::move(steps));
+	});
+
+	// compile and link the shaders once, or load the binary a previous run left in shader_cache
+	program = programs.get(quantizedVertices ? quantized_vertex_shader_src : vertex_shader_src, fragment_shader_src);
+	// the uniforms of every frame get their own range of the ring buffer
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	bindUniformBlock(program, "Frame", frameBinding);
+	std::cout << "Uniform ring buffer " << (uniformRing.persistent() ? "persistently mapped" : "staged, no buffer storage") << std::endl;
+	std::cout << "Program ready after " << programs.setupTime() << " ms (" << (programs.loadedBinaries() ? "binary cache" : "compiled") << ")" << std::endl;
 
 	window.attach(this);
 }
@@ -417,151 +458,89 @@ float Renderer::deg2rad(float degrees) {
 
 void Renderer::render()
 {
+	PROFILE_ZONE("render");
+
+	// hand over what the workers finished, the rest waits for the next frame
+	assets.upload(uploadBudgetMs);
+	if (addDegree == 0)
+		std::cout << "First frame after " << millisecondsSinceStart() << " ms, " << assets.pending() << " assets pending" << std::endl;
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	//addDegree = 0;
 	glViewport(0, 0, viewport_width, viewport_height);
-	// set the afine transformation vlaues
-	rotX = deg2rad(0.04f*addDegree);
-	rotY = deg2rad(-0.08f*addDegree);
-	rotZ = deg2rad(0.01f*addDegree);
-	
-
-	float sinX = sin(rotX), cosX = cos(rotX),
-		sinY = sin(rotY), cosY = cos(rotY),
-		sinZ = sin(rotZ), cosZ = cos(rotZ);
-
-	// define the matrices
-	scaleM = math::float4x4(sX, 0, 0, 0, 0, sY, 0, 0, 0, 0, sZ, 0, 0, 0, 0, 1);
-
-
-	rotationXM._22 = cosX;
-	rotationXM._33 = cosX;
-	rotationXM._23 = -sinX;
-	rotationXM._32 = sinX;
-
-	rotationYM._11 = cosY;
-	rotationYM._33 = cosY;
-	rotationYM._13 = sinY;
-	rotationYM._31 = -sinY;
-
-	rotationZM._11 = cosZ;
-	rotationZM._22 = cosZ;
-	rotationZM._12 = -sinZ;
-	rotationZM._21 = sinZ;
-
-	modelM = rotationXM * rotationYM * rotationZM * scaleM;
-	modelM._14 = tX;
-	modelM._24 = tY;
-	modelM._34 = tZ;
+	// set the afine transformation vlaues, the scene graph rebuilds the matrices of what changed
+	Transform model = scene.local(modelNode);
+	model.rotation = math::float3(deg2rad(0.04f*addDegree), deg2rad(-0.08f*addDegree), deg2rad(0.01f*addDegree));
+	scene.setLocal(modelNode, model);
+	scene.update();
+	const math::float4x4& modelM = scene.world(modelNode);
 
 	//std::cout << modelM << "\n" << std::endl;
 
-	modelMGL[0][0] = modelM._11;
-	modelMGL[0][1] = modelM._12;
-	modelMGL[0][2] = modelM._13;
-	modelMGL[0][3] = modelM._14;
-	modelMGL[1][0] = modelM._21;
-	modelMGL[1][1] = modelM._22;
-	modelMGL[1][2] = modelM._23;
-	modelMGL[1][3] = modelM._24;
-	modelMGL[2][0] = modelM._31;
-	modelMGL[2][1] = modelM._32;
-	modelMGL[2][2] = modelM._33;
-	modelMGL[2][3] = modelM._34;
-	modelMGL[3][0] = modelM._41;
-	modelMGL[3][1] = modelM._42;
-	modelMGL[3][2] = modelM._43;
-	modelMGL[3][3] = modelM._44;
-
-//	GLfloat modelMGL[4][4] = {
-//		{ modelM._11, modelM._12, modelM._13, modelM._14 },
-//		{ modelM._21, modelM._22, modelM._23, modelM._24 },
-//		{ modelM._31, modelM._32, modelM._33, modelM._34 },
-//		{ modelM._41, modelM._42, modelM._43, modelM._44 }
-//	};
-
 	// view matrix
 	cameraPos = math::float3(cameraX, cameraY, cameraZ);
-	W = normalize(cameraPos - math::float3(lookAtX, lookAtY, lookAtZ));
 	cameraUP = math::float3(cameraUpX, cameraUpY, cameraUpZ);
-	U = normalize(cross(cameraUP, W));
-	V = cross(W, U);
-
-	viewMGL[0][0] = U[0];
-	viewMGL[0][1] = U[1];
-	viewMGL[0][2] = U[2];
-	viewMGL[0][3] = -dot(cameraPos, U);
-
-	viewMGL[1][0] = V[0];
-	viewMGL[1][1] = V[1];
-	viewMGL[1][2] = V[2];
-	viewMGL[1][3] = -dot(cameraPos, V);
-
-	viewMGL[2][0] = W[0];
-	viewMGL[2][1] = W[1];
-	viewMGL[2][2] = W[2];
-	viewMGL[2][3] = -dot(cameraPos, W);
-
-//	GLfloat viewMGL[4][4] = {
-//		{ U[0], U[1], U[2], -dot(cameraPos, U) },
-//		{ V[0], V[1], V[2], -dot(cameraPos, V) },
-//		{ W[0], W[1], W[2], -dot(cameraPos, W) },
-//		{ 0.0f, 0.0f, 0.0f, 1.0f }
-//	};
+	viewM = math::look_at(cameraPos, math::float3(lookAtX, lookAtY, lookAtZ), cameraUP);
 
 	// projection matrix
 	float viewAngle = deg2rad(60),
 		aspect = float(viewport_width) / float(viewport_height),
 		tanFieldViewAngle = tan(viewAngle / 2.0f);
 
-	projectionMGL[0][0] = 1.0f / (aspect * tanFieldViewAngle);
-	projectionMGL[1][1] = 1.0f / (aspect * tanFieldViewAngle);
-	projectionMGL[2][2] = -(farFrame + nearFrame) / (farFrame - nearFrame);
-	projectionMGL[2][3] = -(2 * farFrame * nearFrame) / (farFrame - nearFrame);
-		
-//		[4][4] = {
-//		{ 1.0f / (aspect * tanFieldViewAngle), 0.0f, 0.0f, 0.0f },
-//		{ 0.0f, 1.0f / tanFieldViewAngle,  0.0f, 0.0f },
-//		{ 0.0f, 0.0f, -(farFrame + nearFrame) / (farFrame - nearFrame), -(2 * farFrame * nearFrame) / (farFrame - nearFrame) },
-//		{ 0.0f, 0.0f, -1.0f, 0.0f }
-//	};
-
-	// create program to which we connect the shaders
-	GLuint program = GL_SAFE_CALL(glCreateProgram());
-
-	// load vertex shader
-	GLuint vertexShader = GL_SAFE_CALL(glCreateShader(GL_VERTEX_SHADER));
-	GL_SAFE_CALL(glShaderSource(vertexShader, 1, &vertex_shader_src, 0));
-	GL_SAFE_CALL(glCompileShader(vertexShader));
-	GL_SAFE_CALL(glAttachShader(program, vertexShader));
-	// load fragment shader
-	GLuint fragmentShader = GL_SAFE_CALL(glCreateShader(GL_FRAGMENT_SHADER));
-	GL_SAFE_CALL(glShaderSource(fragmentShader, 1, &fragment_shader_src, 0));
-	GL_SAFE_CALL(glCompileShader(fragmentShader));
-	GL_SAFE_CALL(glAttachShader(program, fragmentShader));
-
-	// link the program to the GPU
-	GL_SAFE_CALL(glLinkProgram(program));
-
-	// use the program
-	glUseProgram(program);
-
-	// link matrices to uniforms after load
-	GLint modelUniform = GL_SAFE_CALL(glGetUniformLocation(program, "Model"));
-	GL_SAFE_CALL(glUniformMatrix4fv(modelUniform, 1, GL_TRUE, *modelMGL));
-	GLint viewUniform = GL_SAFE_CALL(glGetUniformLocation(program, "View"));
-	GL_SAFE_CALL(glUniformMatrix4fv(viewUniform, 1, GL_TRUE, *viewMGL));
-	GLint projectionUniform = GL_SAFE_CALL(glGetUniformLocation(program, "Projection"));
-	GL_SAFE_CALL(glUniformMatrix4fv(projectionUniform, 1, GL_TRUE, *projectionMGL));
-	// link uniform values to fragment shader
-	GLint piUniform = GL_SAFE_CALL(glGetUniformLocation(program, "PI"));
-	GL_SAFE_CALL(glUniform1f(piUniform, pi));
-	GLint lightUniform = GL_SAFE_CALL(glGetUniformLocation(program, "LightRGB"));
-	GL_SAFE_CALL(glUniform4f(lightUniform, 1.0f, 1.0f, 1.0f, 1.0f));
+	projectionM = math::float4x4(
+		1.0f / (aspect * tanFieldViewAngle), 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f / (aspect * tanFieldViewAngle), 0.0f, 0.0f,
+		0.0f, 0.0f, -(farFrame + nearFrame) / (farFrame - nearFrame), -(2 * farFrame * nearFrame) / (farFrame - nearFrame),
+		0.0f, 0.0f, -1.0f, 0.0f
+	);
+
+	// everything this frame draws with; what is still bound from the frame before is not bound again
+	glState.beginFrame();
+	glState.useProgram(program);
+	glState.bindVertexArray(vao);
+	glState.bindTexture(GL_TEXTURE_2D, texture);
+
+	// matrices, light and vertex decoding for both shaders, written straight into the ring buffer
+	uniformRing.beginFrame();
+	RingBuffer::Allocation frameRange = uniformRing.allocate(sizeof(FrameUniforms), uniformAlignment);
+	FrameUniforms& frame = *static_cast<FrameUniforms*>(frameRange.data);
+	frame.model = modelM;
+	frame.view = viewM;
+	frame.projection = projectionM;
+	frame.lightRGB = math::float4(1.0f, 1.0f, 1.0f, 1.0f);
+	frame.positionOffset = positionOffset;
+	frame.positionScale = positionScale;
+	frame.uvOffset = uvOffset;
+	frame.uvScale = uvScale;
+	frame.pi = pi;
+	uniformRing.flush();
+	glState.bindBufferRange(GL_UNIFORM_BUFFER, frameBinding, uniformRing, frameRange.offset, frameRange.size);
+
+	// pick the LOD from how large its error appears at the distance of the mesh center
+	math::float4 center = modelM * math::float4(meshCenter, 1.0f);
+	float distance = length(math::float3(center.x, center.y, center.z) - cameraPos);
+	float pixels = pixelsPerUnit(std::max(model.scale.x, std::max(model.scale.y, model.scale.z)), distance, viewAngle, viewport_height);
+	const MeshLod& lod = meshLods[lodSelector.select(meshLods.data(), meshLods.size(), pixels, lodThresholdPixels)];
+
+	trianglesDrawn += lod.index_count / 3;
+	trianglesFull += meshLods[0].index_count / 3;
+	if ((addDegree + 1) % lodReportFrames == 0) {
+		std::cout << "LOD " << lodSelector.lod() << ": drew " << trianglesDrawn << " of " << trianglesFull << " triangles ("
+			<< 100.0 * (1.0 - double(trianglesDrawn) / trianglesFull) << "% saved)" << std::endl;
+		// these stay constant unless something leaks
+		std::cout << "GL objects alive: " << VertexArray::liveCount() << " vertex arrays, " << Buffer::liveCount() << " buffers, "
+			<< Texture::liveCount() << " textures, " << Program::liveCount() << " programs" << std::endl;
+		std::cout << "Uniform ring: waited for the GPU in " << uniformRing.stalls() << " of " << uniformRing.frames() << " frames, "
+			<< uniformRing.stallTime() << " ms" << std::endl;
+		std::cout << "GL state: " << glState.lastFrameCounters().elided << " of " << glState.lastFrameCounters().calls() << " calls elided last frame" << std::endl;
+	}
 
 	// start vertex shader to draw the triangles
-	GL_SAFE_CALL(glDrawArrays(GL_TRIANGLES, 0, totalVertexCount));
+	GL_SAFE_CALL(glDrawElements(GL_TRIANGLES, lod.index_count, indexType, (void*)(std::size_t(lod.index_offset) * indexSize)));
+
+	// the GPU is done with this frame's uniforms once it gets past here
+	uniformRing.endFrame();
 
 	swapBuffers();
 	addDegree++;
@@ -8,9 +8,15 @@
 
 #include <GL/gl.h>
 #include <framework/BasicRenderer.h>
-#include "math\math.h"
-#include "math\vector.h"
-#include "math\matrix.h"
+#include <framework/gl_objects.h>
+#include <framework/shader.h>
+#include <framework/ring_buffer.h>
+#include <framework/asset_loader.h>
+#include <framework/scene_graph.h>
+#include <framework/gl_state.h>
+#include "math/math.h"
+#include "math/vector.h"
+#include "math/matrix.h"
 
 
 class Renderer : public BasicRenderer
@@ -19,6 +25,25 @@ private:
 	int viewport_width;
 	int viewport_height;
 
+	ProgramCache programs;
+	GLuint program;
+
+	// every bind and enable goes through here, so the ones that change nothing are left out
+	GLStateCache glState;
+
+	// filled by the asset loader, a placeholder is drawn until then
+	VertexArray vao;
+	Buffer vertexVOB;
+	Buffer indexVOB;
+	Texture texture;
+	RingBuffer uniformRing;
+
+	AssetLoader assets;
+
+	// the model is a node of its own, the transformation settings are its local transform
+	SceneGraph scene;
+	SceneGraph::Node modelNode;
+
 public:
 	Renderer(const Renderer&) = delete;
 	Renderer& operator =(const Renderer&) = delete;
@@ -2,6 +2,7 @@
 
 
 #include "Renderer.h"
+#include "framework/instrumentation/profiler.h"
 
 
 Renderer::Renderer(GL::platform::Window& window)
@@ -22,6 +23,8 @@ void Renderer::resize(int width, int height)
 
 void Renderer::render()
 {
+	PROFILE_ZONE("render");
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	glViewport(0, 0, viewport_width, viewport_height);